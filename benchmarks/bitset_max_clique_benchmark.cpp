@@ -0,0 +1,159 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file bitset_max_clique_benchmark.cpp
+ *  \brief Maximum clique searched by the Fast Max-Cliquer and on bitsets with coloring bounds.
+ */
+
+#include "graph_utils/graph_utils_functions.h"
+#include "pairwise_consistency/pairwise_consistency.h"
+#include "max_clique_solver/fmc_graph.h"
+#include "max_clique_solver/bitset_max_clique.h"
+#include "robot_local_map/robot_local_map.h"
+#include "findClique.h"
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+namespace {
+
+/** Random graph of edge probability density, with a clique planted on planted_clique_size random vertices */
+void generateGraph(const size_t& nb_vertices, const double& density, const size_t& planted_clique_size, FMC::CGraphIO& gio) {
+    std::mt19937 generator(42);
+    std::bernoulli_distribution is_edge(density);
+    std::vector<int> permutation(nb_vertices);
+    for (size_t vertex = 0; vertex < nb_vertices; vertex++) {
+        permutation[vertex] = vertex;
+    }
+    std::shuffle(permutation.begin(), permutation.end(), generator);
+    std::vector<std::vector<int>> neighbors(nb_vertices);
+    for (size_t u = 0; u < nb_vertices; u++) {
+        // Skipping geometrically distributed numbers of non-edges, for the sparse graphs
+        std::geometric_distribution<size_t> gap(std::max(density, 1e-12));
+        for (size_t v = u + 1; v < nb_vertices; v++) {
+            if (v >= planted_clique_size) {
+                v += density < 1 ? gap(generator) : 0;
+                if (v >= nb_vertices) {
+                    break;
+                }
+            }
+            neighbors[permutation[u]].push_back(permutation[v]);
+            neighbors[permutation[v]].push_back(permutation[u]);
+        }
+    }
+    std::vector<int> vertices(1, 0), edges;
+    for (auto& vertex_neighbors: neighbors) {
+        std::sort(vertex_neighbors.begin(), vertex_neighbors.end());
+        edges.insert(edges.end(), vertex_neighbors.begin(), vertex_neighbors.end());
+        vertices.push_back(edges.size());
+    }
+    gio.SetAdjacencyGraph(vertices, edges);
+}
+
+/** Checks that the vertices form a clique of the graph */
+bool isClique(FMC::CGraphIO& gio, const std::vector<int>& clique) {
+    const std::vector<int>& vertices = *gio.GetVerticesPtr();
+    const std::vector<int>& edges = *gio.GetEdgesPtr();
+    for (size_t first = 0; first < clique.size(); first++) {
+        for (size_t second = first + 1; second < clique.size(); second++) {
+            if (std::find(edges.begin() + vertices[clique[first]], edges.begin() + vertices[clique[first] + 1], clique[second]) ==
+                edges.begin() + vertices[clique[first] + 1]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** Maximum clique with FMC::maxClique and with the bitset search */
+void reportSearches(const std::string& name, FMC::CGraphIO& gio, const int& nb_runs) {
+    std::vector<int> fmc_clique;
+    int fmc_size = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        fmc_clique.clear();
+        fmc_size = FMC::maxClique(gio, 0, fmc_clique);
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    const double fmc_milliseconds = std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+
+    // Construction of the bitsets, then search
+    std::vector<int> bitset_clique;
+    int bitset_size = 0, upper_bound = 0;
+    size_t nb_expanded_nodes = 0;
+    double build_milliseconds = 0, search_milliseconds = 0;
+    for (int run = 0; run < nb_runs; run++) {
+        start = std::chrono::high_resolution_clock::now();
+        max_clique_solver::BitsetMaxClique search(gio);
+        auto middle = std::chrono::high_resolution_clock::now();
+        bitset_size = search.findMaxClique(0, bitset_clique);
+        finish = std::chrono::high_resolution_clock::now();
+        build_milliseconds += std::chrono::duration<double, std::milli>(middle - start).count() / nb_runs;
+        search_milliseconds += std::chrono::duration<double, std::milli>(finish - middle).count() / nb_runs;
+        nb_expanded_nodes = search.getNbExpandedNodes();
+        upper_bound = search.getUpperBound();
+    }
+
+    std::cout << name << " : " << gio.GetVertexCount() << " vertices, " << gio.GetEdgeCount() << " edges, density "
+              << 2.0 * gio.GetEdgeCount() / std::max(1.0, double(gio.GetVertexCount()) * (gio.GetVertexCount() - 1))
+              << ", degeneracy bound " << upper_bound << std::endl;
+    std::cout << "  FMC::maxClique : " << fmc_milliseconds << " ms, maximum clique " << fmc_size << std::endl;
+    std::cout << "  bitsets and coloring : " << build_milliseconds + search_milliseconds << " ms (" << build_milliseconds
+              << " ms for the bitsets, x" << fmc_milliseconds / (build_milliseconds + search_milliseconds) << "), "
+              << nb_expanded_nodes << " nodes, maximum clique " << bitset_size
+              << (bitset_size == fmc_size && isClique(gio, bitset_clique) ? ", valid" : ", INVALID") << std::endl;
+}
+
+}
+
+/** \brief Benchmark of the maximum clique search on bitsets with coloring bounds against the Fast Max-Cliquer.
+ *
+ * Arguments : <trajectory robot1 file> <trajectory robot2 file> <inter robot loop closures file>... [number of runs (default 1)]
+ * Compares the searches on the consistency graph of each file of inter robot loop closures, on dense random graphs,
+ * with and without a large planted clique as the consistency graphs of loop closures with many inliers, and on a
+ * sparse random graph with a planted clique.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "Please specify at least 3 input files, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL_robot1.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_robot2.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures_outliers.g2o" << std::endl;
+        return -1;
+    }
+    int nb_files = argc;
+    int nb_runs = 1;
+    const std::string last_argument = argv[argc - 1];
+    if (last_argument.find_first_not_of("0123456789") == std::string::npos) {
+        nb_runs = std::stoi(last_argument);
+        nb_files--;
+    }
+
+    auto robot1_local_map = robot_local_map::RobotLocalMap(argv[1]);
+    auto robot2_local_map = robot_local_map::RobotLocalMap(argv[2]);
+    for (int arg = 3; arg < nb_files; arg++) {
+        auto interrobot_measurements = robot_local_map::RobotMeasurements(argv[arg], true);
+        pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+            interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+            robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom());
+        FMC::CGraphIO gio;
+        max_clique_solver::loadConsistencyGraph(pairwise_consistency.computeConsistencyGraph(), gio);
+        reportSearches(argv[arg], gio, nb_runs);
+    }
+
+    FMC::CGraphIO dense_gio;
+    generateGraph(300, 0.5, 0, dense_gio);
+    reportSearches("dense random graph", dense_gio, nb_runs);
+
+    FMC::CGraphIO planted_gio;
+    generateGraph(1000, 0.3, 100, planted_gio);
+    reportSearches("dense random graph with a planted clique", planted_gio, nb_runs);
+
+    FMC::CGraphIO sparse_gio;
+    generateGraph(20000, 0.001, 30, sparse_gio);
+    reportSearches("sparse random graph with a planted clique", sparse_gio, nb_runs);
+
+    return 0;
+}
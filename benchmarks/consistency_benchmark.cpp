@@ -0,0 +1,252 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file consistency_benchmark.cpp
+ *  \brief Cost of the computation of the pairwise consistency matrix.
+ */
+
+#include "graph_utils/graph_utils_functions.h"
+#include "pairwise_consistency/pairwise_consistency.h"
+#include "robot_local_map/robot_local_map.h"
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+/** Variance given to z, roll and pitch when planar measurements are processed in 3D */
+const double PLANAR_EMBEDDING_VARIANCE = 1e-2;
+
+/** Copy of planar measurements, with a small variance on z, roll and pitch so that they can be processed in 3D */
+graph_utils::Transforms embedIn3D(const graph_utils::Transforms& transforms) {
+    graph_utils::Transforms result;
+    result.start_id = transforms.start_id;
+    result.end_id = transforms.end_id;
+    result.transforms.reserve(transforms.transforms.size());
+    for (size_t index = 0; index < transforms.transforms.size(); index++) {
+        graph_utils::Transform transform = transforms.transforms.at(index);
+        for (const int& k: {2, 3, 4}) {
+            transform.pose.covariance[k * 6 + k] = PLANAR_EMBEDDING_VARIANCE;
+        }
+        result.transforms.insert(transform);
+    }
+    return result;
+}
+
+/** Computes the consistency matrix, returns the time per run in milliseconds */
+double timeConsistencyMatrix(pairwise_consistency::PairwiseConsistency& pairwise_consistency, const int& nb_runs, Eigen::MatrixXi& consistency_matrix) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        consistency_matrix = pairwise_consistency.computeConsistentMeasurementsMatrix();
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+}
+
+/** Ratio of a reference time to a time, as "xN faster" or "xN slower" whichever it is */
+std::string formatSpeedup(const double& reference_milliseconds, const double& milliseconds) {
+    const double ratio = reference_milliseconds / milliseconds;
+    std::ostringstream speedup;
+    speedup << "x" << (ratio >= 1 ? ratio : 1 / ratio) << (ratio >= 1 ? " faster" : " slower");
+    return speedup.str();
+}
+
+/** Time and memory of the sparse consistency graph, compared with the dense consistency matrix */
+void reportConsistencyGraph(pairwise_consistency::PairwiseConsistency& pairwise_consistency, const int& nb_runs,
+                            const Eigen::MatrixXi& reference_matrix, const double& reference_milliseconds) {
+    graph_utils::ConsistencyGraph consistency_graph;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        consistency_graph = pairwise_consistency.computeConsistencyGraph();
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    const double milliseconds = std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+
+    bool is_identical = consistency_graph.getNbEdges() == (size_t) reference_matrix.triangularView<Eigen::StrictlyUpper>().toDenseMatrix().sum();
+    for (uint32_t u = 0; u < consistency_graph.getNbVertices() && is_identical; u++) {
+        for (const uint32_t* v = consistency_graph.beginNeighbors(u); v != consistency_graph.endNeighbors(u); v++) {
+            is_identical = is_identical && reference_matrix(std::min(u, *v), std::max(u, *v)) == 1;
+        }
+    }
+    std::cout << "Sparse consistency graph : " << milliseconds << " ms (x" << milliseconds / reference_milliseconds << " the dense matrix), "
+              << consistency_graph.getNbEdges() << " edges, " << consistency_graph.getMemoryUsage() << " bytes instead of "
+              << reference_matrix.size() * sizeof(int) << " bytes" << (is_identical ? ", identical" : ", DIFFERENT") << std::endl;
+}
+
+/** Time and memory of the packed consistency matrix, compared with the dense consistency matrix */
+void reportPackedConsistencyMatrix(pairwise_consistency::PairwiseConsistency& pairwise_consistency, const int& nb_runs,
+                                   const Eigen::MatrixXi& reference_matrix, const double& reference_milliseconds) {
+    graph_utils::PackedConsistencyMatrix packed_matrix;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        packed_matrix = pairwise_consistency.computePackedConsistencyMatrix();
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    const double milliseconds = std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+
+    bool is_identical = true;
+    const std::vector<size_t> degrees = packed_matrix.computeDegrees();
+    for (size_t u = 0; u < packed_matrix.getNbVertices(); u++) {
+        size_t degree = 0;
+        for (size_t v = 0; v < packed_matrix.getNbVertices(); v++) {
+            const bool is_consistent = u != v && reference_matrix(std::min(u, v), std::max(u, v)) == 1;
+            is_identical = is_identical && packed_matrix.test(u, v) == is_consistent;
+            degree += is_consistent;
+        }
+        is_identical = is_identical && degrees[u] == degree;
+    }
+    std::cout << "Packed consistency matrix : " << milliseconds << " ms (x" << milliseconds / reference_milliseconds << " the dense matrix), "
+              << packed_matrix.getNbEdges() << " edges, " << packed_matrix.getMemoryUsage() << " bytes instead of "
+              << reference_matrix.size() * sizeof(int) << " bytes" << (is_identical ? ", identical" : ", DIFFERENT") << std::endl;
+}
+
+/** Pairs rejected by the first stage of the evaluation, and time without it */
+void reportEarlyRejection(const robot_local_map::RobotLocalMap& robot1_local_map, const robot_local_map::RobotLocalMap& robot2_local_map,
+                          const robot_local_map::RobotMeasurements& interrobot_measurements, const int& nb_runs,
+                          const pairwise_consistency::ConsistencyStatistics& statistics,
+                          const Eigen::MatrixXi& reference_matrix, const double& reference_milliseconds) {
+    pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+        interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+        robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom(), 1, false);
+    Eigen::MatrixXi consistency_matrix;
+    const double milliseconds = timeConsistencyMatrix(pairwise_consistency, nb_runs, consistency_matrix);
+    std::cout << "Early rejection : " << statistics.nb_early_rejected_pairs << " of " << statistics.nb_interrobot_pairs << " inter-robot pairs ("
+              << 100.0 * statistics.nb_early_rejected_pairs / std::max<size_t>(1, statistics.nb_interrobot_pairs) << "%) rejected before the covariance propagation, "
+              << milliseconds << " ms without it (" << formatSpeedup(milliseconds, reference_milliseconds) << " with it)"
+              << (consistency_matrix == reference_matrix ? ", identical" : ", DIFFERENT") << std::endl;
+}
+
+/** Sweep of the threshold : evaluation of the pairs for each threshold, compared with a single evaluation of the distances */
+void reportThresholdSweep(pairwise_consistency::PairwiseConsistency& pairwise_consistency, const int& nb_runs,
+                          const Eigen::MatrixXi& reference_matrix) {
+    const double default_threshold = pairwise_consistency.getChiSquaredThreshold();
+    const std::vector<double> thresholds = {default_threshold / 4, default_threshold / 2, default_threshold,
+                                            2 * default_threshold, 4 * default_threshold};
+
+    // Evaluation of the pairs for each threshold
+    std::vector<size_t> nb_edges(thresholds.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        for (size_t index = 0; index < thresholds.size(); index++) {
+            nb_edges[index] = pairwise_consistency.computeConsistencyDistances(thresholds[index]).getEntries().size();
+        }
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    const double milliseconds = std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+
+    // Single evaluation of the distances, then one pass over them per threshold
+    graph_utils::ConsistencyDistances distances;
+    std::vector<graph_utils::ConsistencyGraph> consistency_graphs(thresholds.size());
+    start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        distances = pairwise_consistency.computeConsistencyDistances(thresholds.back());
+        for (size_t index = 0; index < thresholds.size(); index++) {
+            consistency_graphs[index] = distances.computeConsistencyGraph(thresholds[index]);
+        }
+    }
+    finish = std::chrono::high_resolution_clock::now();
+    const double sweep_milliseconds = std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+
+    bool is_identical = true;
+    for (size_t index = 0; index < thresholds.size(); index++) {
+        is_identical = is_identical && consistency_graphs[index].getNbEdges() == nb_edges[index];
+    }
+    const graph_utils::ConsistencyGraph& default_graph = consistency_graphs[2];
+    is_identical = is_identical && default_graph.getNbEdges() == (size_t) reference_matrix.sum();
+    for (uint32_t u = 0; u < default_graph.getNbVertices() && is_identical; u++) {
+        for (const uint32_t* v = default_graph.beginNeighbors(u); v != default_graph.endNeighbors(u); v++) {
+            is_identical = is_identical && reference_matrix(std::min(u, *v), std::max(u, *v)) == 1;
+        }
+    }
+    std::cout << "Threshold sweep : " << sweep_milliseconds << " ms from the distances instead of " << milliseconds << " ms ("
+              << formatSpeedup(milliseconds, sweep_milliseconds) << "), " << distances.getEntries().size() << " distances in "
+              << distances.getMemoryUsage() << " bytes" << (is_identical ? ", identical" : ", DIFFERENT") << std::endl;
+    for (size_t index = 0; index < thresholds.size(); index++) {
+        std::cout << "  threshold " << thresholds[index] << " : " << consistency_graphs[index].getNbEdges() << " consistent pairs" << std::endl;
+    }
+}
+
+/** Time of the consistency matrix from 1 thread to max_nb_threads, doubling the number of threads */
+void reportStrongScaling(const robot_local_map::RobotLocalMap& robot1_local_map, const robot_local_map::RobotLocalMap& robot2_local_map,
+                         const robot_local_map::RobotMeasurements& interrobot_measurements, const int& nb_runs,
+                         const size_t& max_nb_threads, const Eigen::MatrixXi& reference_matrix, const double& reference_milliseconds) {
+    std::cout << "Strong scaling (" << pairwise_consistency::PairwiseConsistency::TILE_SIZE << "x"
+              << pairwise_consistency::PairwiseConsistency::TILE_SIZE << " tiles)" << std::endl;
+    std::cout << "  1 thread(s) : " << reference_milliseconds << " ms" << std::endl;
+    for (size_t nb_threads = 2; nb_threads < 2 * max_nb_threads; nb_threads *= 2) {
+        nb_threads = std::min(nb_threads, max_nb_threads);
+        pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+            interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+            robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom(), nb_threads);
+        Eigen::MatrixXi consistency_matrix;
+        const double milliseconds = timeConsistencyMatrix(pairwise_consistency, nb_runs, consistency_matrix);
+        const double speedup = reference_milliseconds / milliseconds;
+        std::cout << "  " << nb_threads << " thread(s) : " << milliseconds << " ms, speedup " << speedup
+                  << ", efficiency " << speedup / nb_threads
+                  << (consistency_matrix == reference_matrix ? ", identical" : ", DIFFERENT") << std::endl;
+    }
+}
+
+}
+
+/** \brief Benchmark of the pairwise consistency matrix computation.
+ *
+ * Arguments : <trajectory robot1 file> <trajectory robot2 file> <inter robot loop closures file> [number of runs (default 10)]
+ *             [maximum number of threads (default all the hardware threads)]
+ * Times the consistency matrix with the kernels of the dimension of the measurements. Planar measurements are also
+ * processed with the 3D kernels, after giving a small variance to z, roll and pitch, to show the cost of the 6D path.
+ * Then reports the pairs rejected by the first stage of the evaluation and the time without it, compares the sparse
+ * consistency graph and the packed matrix with the dense matrix, times a sweep of the threshold with and without the stored distances, reports the strong scaling of the computation
+ * and checks that the matrices do not depend on the number of threads.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "Please specify 3 input files, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL_robot1.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_robot2.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures_outliers.g2o" << std::endl;
+        return -1;
+    }
+    const int nb_runs = argc > 4 ? std::stoi(argv[4]) : 10;
+    const size_t max_nb_threads = argc > 5 ? std::stoul(argv[5]) : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    auto robot1_local_map = robot_local_map::RobotLocalMap(argv[1]);
+    auto robot2_local_map = robot_local_map::RobotLocalMap(argv[2]);
+    auto interrobot_measurements = robot_local_map::RobotMeasurements(argv[3], true);
+    const uint8_t nb_degree_freedom = robot1_local_map.getNbDegreeFreedom();
+
+    pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+        interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+        robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), nb_degree_freedom);
+    Eigen::MatrixXi consistency_matrix;
+    const double milliseconds = timeConsistencyMatrix(pairwise_consistency, nb_runs, consistency_matrix);
+
+    std::cout << interrobot_measurements.getLoopClosures().size() << " loop closures, " << (int) nb_degree_freedom << " degrees of freedom" << std::endl;
+    std::cout << "  " << (nb_degree_freedom == 3 ? "SE2 kernels" : "SE3 kernels") << " : " << milliseconds << " ms, "
+              << consistency_matrix.sum() << " consistent pairs" << std::endl;
+
+    if (nb_degree_freedom == 3) {
+        const graph_utils::Transforms transforms_robot1 = embedIn3D(robot1_local_map.getTransforms());
+        const graph_utils::Transforms transforms_robot2 = embedIn3D(robot2_local_map.getTransforms());
+        const graph_utils::Transforms transforms_interrobot = embedIn3D(interrobot_measurements.getTransforms());
+        pairwise_consistency::PairwiseConsistency pairwise_consistency_3d(transforms_robot1, transforms_robot2,
+            transforms_interrobot, interrobot_measurements.getLoopClosures(),
+            graph_utils::buildTrajectory(transforms_robot1), graph_utils::buildTrajectory(transforms_robot2), 6);
+        Eigen::MatrixXi consistency_matrix_3d;
+        const double milliseconds_3d = timeConsistencyMatrix(pairwise_consistency_3d, nb_runs, consistency_matrix_3d);
+        std::cout << "  SE3 kernels : " << milliseconds_3d << " ms, " << consistency_matrix_3d.sum() << " consistent pairs (x"
+                  << milliseconds_3d / milliseconds << " slower)" << std::endl;
+    }
+
+    reportEarlyRejection(robot1_local_map, robot2_local_map, interrobot_measurements, nb_runs, pairwise_consistency.getStatistics(),
+                         consistency_matrix, milliseconds);
+    reportConsistencyGraph(pairwise_consistency, nb_runs, consistency_matrix, milliseconds);
+    reportPackedConsistencyMatrix(pairwise_consistency, nb_runs, consistency_matrix, milliseconds);
+    reportThresholdSweep(pairwise_consistency, nb_runs, consistency_matrix);
+    reportStrongScaling(robot1_local_map, robot2_local_map, interrobot_measurements, nb_runs, max_nb_threads, consistency_matrix, milliseconds);
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file consistency_loop_benchmark.cpp
+ *  \brief Per-pair cost of the consistency loop, composed from the six factors and from the row and column terms.
+ */
+
+#include "graph_utils/pose_algebra.h"
+#include "pairwise_consistency/pairwise_consistency.h"
+#include "robot_local_map/robot_local_map.h"
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
+namespace {
+
+/** Pair of inter-robot loop closures with a common orientation */
+struct LoopPair {
+    size_t u, v;
+    int robot_a;
+};
+
+/** Pairs of the loop closure table that form an inter-robot consistency loop */
+template <typename Pose>
+std::vector<LoopPair> collectPairs(const pairwise_consistency::ConsistencyPoses<Pose>& poses) {
+    std::vector<LoopPair> pairs;
+    for (size_t u = 0; u < poses.loop_closure_entries.size(); u++) {
+        for (size_t v = u + 1; v < poses.loop_closure_entries.size(); v++) {
+            const uint8_t orientations = poses.loop_closure_entries[u].orientations & poses.loop_closure_entries[v].orientations;
+            if (orientations != 0) {
+                pairs.push_back({u, v, (orientations & pairwise_consistency::LoopClosureEntry::ROBOT1_TO_ROBOT2) ? 0 : 1});
+            }
+        }
+    }
+    return pairs;
+}
+
+/** Consistency loop of a pair from its six factors : aXij + abZjl + bXlk - abZik, five operations */
+template <typename Pose>
+void composeFactors(const pairwise_consistency::ConsistencyPoses<Pose>& poses, const LoopPair& pair, Pose& result) {
+    const int robot_b = 1 - pair.robot_a;
+    const pairwise_consistency::LoopClosureEntry& entry_ik = poses.loop_closure_entries[pair.u];
+    const pairwise_consistency::LoopClosureEntry& entry_jl = poses.loop_closure_entries[pair.v];
+    Pose aXij, bXlk, out1, out2;
+    graph_utils::inverseCompose(poses.trajectories[pair.robot_a][entry_jl.first_indexes[pair.robot_a]],
+                                poses.trajectories[pair.robot_a][entry_ik.first_indexes[pair.robot_a]], aXij);
+    graph_utils::inverseCompose(poses.trajectories[robot_b][entry_ik.second_indexes[robot_b]],
+                                poses.trajectories[robot_b][entry_jl.second_indexes[robot_b]], bXlk);
+    graph_utils::compose(aXij, poses.loop_closures[pair.v], out1);
+    graph_utils::compose(out1, bXlk, out2);
+    graph_utils::inverseCompose(out2, poses.loop_closures[pair.u], result);
+}
+
+/** Consistency loop of a pair from the terms of the loop closure table : (abZik^-1 + aXi^-1) + (aXj + abZjl + bXl^-1) + bXk */
+template <typename Pose>
+void composeTerms(const pairwise_consistency::ConsistencyPoses<Pose>& poses, const LoopPair& pair, Pose& result) {
+    const int robot_b = 1 - pair.robot_a;
+    Pose row_column;
+    graph_utils::compose(poses.row_terms[pair.robot_a][pair.u], poses.column_terms[pair.robot_a][pair.v], row_column);
+    graph_utils::compose(row_column, poses.trajectories[robot_b][poses.loop_closure_entries[pair.u].second_indexes[robot_b]], result);
+}
+
+/** Largest difference between the means of two poses, positions and angles mixed */
+double meanDifference(const graph_utils::PoseSE2& a, const graph_utils::PoseSE2& b) {
+    return std::max((a.mean.head<2>() - b.mean.head<2>()).cwiseAbs().maxCoeff(),
+                    std::abs(graph_utils::internal::wrapAngle(a.mean(2) - b.mean(2))));
+}
+
+double meanDifference(const graph_utils::PoseSE3& a, const graph_utils::PoseSE3& b) {
+    return std::max((a.translation - b.translation).cwiseAbs().maxCoeff(), (a.rotation - b.rotation).cwiseAbs().maxCoeff());
+}
+
+/** Time per pair of a composition of the consistency loop, the loops are stored so that they are not optimized out */
+template <typename Pose, typename Compose>
+double timePairs(const pairwise_consistency::ConsistencyPoses<Pose>& poses, const std::vector<LoopPair>& pairs,
+                 const int& nb_runs, Compose compose, std::vector<Pose, Eigen::aligned_allocator<Pose>>& loops) {
+    loops.resize(pairs.size());
+    double best_nanoseconds = 0;
+    for (int run = 0; run < nb_runs; run++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t k = 0; k < pairs.size(); k++) {
+            compose(poses, pairs[k], loops[k]);
+        }
+        auto finish = std::chrono::high_resolution_clock::now();
+        const double nanoseconds = std::chrono::duration<double, std::nano>(finish - start).count();
+        best_nanoseconds = run == 0 ? nanoseconds : std::min(best_nanoseconds, nanoseconds);
+    }
+    return best_nanoseconds / std::max<size_t>(1, pairs.size());
+}
+
+/** Compares the two compositions on all the inter-robot pairs */
+template <typename Pose>
+void reportConsistencyLoop(const pairwise_consistency::PairwiseConsistency& pairwise_consistency, const int& nb_runs) {
+    const pairwise_consistency::ConsistencyPoses<Pose>& poses = pairwise_consistency.getLoopClosureTable<Pose>();
+    const std::vector<LoopPair> pairs = collectPairs(poses);
+
+    std::vector<Pose, Eigen::aligned_allocator<Pose>> factor_loops, term_loops;
+    const double factors_nanoseconds = timePairs(poses, pairs, nb_runs, composeFactors<Pose>, factor_loops);
+    const double terms_nanoseconds = timePairs(poses, pairs, nb_runs, composeTerms<Pose>, term_loops);
+
+    double max_mean_difference = 0, max_covariance_difference = 0;
+    for (size_t k = 0; k < pairs.size(); k++) {
+        max_mean_difference = std::max(max_mean_difference, meanDifference(factor_loops[k], term_loops[k]));
+        max_covariance_difference = std::max(max_covariance_difference,
+                                             (factor_loops[k].covariance - term_loops[k].covariance).cwiseAbs().maxCoeff() /
+                                             std::max(1e-12, factor_loops[k].covariance.cwiseAbs().maxCoeff()));
+    }
+
+    std::cout << pairs.size() << " inter-robot pairs, " << graph_utils::PoseTraits<Pose>::DIMENSION << "x"
+              << graph_utils::PoseTraits<Pose>::DIMENSION << " covariances" << std::endl;
+    std::cout << "  loop from the six factors (5 operations) : " << factors_nanoseconds << " ns/pair" << std::endl;
+    std::cout << "  loop from the row and column terms (2 compositions) : " << terms_nanoseconds << " ns/pair (x"
+              << factors_nanoseconds / terms_nanoseconds << " faster)" << std::endl;
+    std::cout << "  largest difference : " << max_mean_difference << " on the mean, "
+              << max_covariance_difference << " relative on the covariance" << std::endl;
+}
+
+}
+
+/** \brief Benchmark of the composition of the consistency loop of the pairs of loop closures.
+ *
+ * Arguments : <trajectory robot1 file> <trajectory robot2 file> <inter robot loop closures file> [number of runs (default 20)]
+ * Times, for all the inter-robot pairs of loop closures, the consistency loop composed from its six factors
+ * and from the terms precomputed once per loop closure, and checks that they agree.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "Please specify 3 input files, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL_robot1.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_robot2.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures_outliers.g2o" << std::endl;
+        return -1;
+    }
+    const int nb_runs = argc > 4 ? std::stoi(argv[4]) : 20;
+
+    auto robot1_local_map = robot_local_map::RobotLocalMap(argv[1]);
+    auto robot2_local_map = robot_local_map::RobotLocalMap(argv[2]);
+    auto interrobot_measurements = robot_local_map::RobotMeasurements(argv[3], true);
+    pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+        interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+        robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom());
+
+    if (robot1_local_map.getNbDegreeFreedom() == 3) {
+        reportConsistencyLoop<graph_utils::PoseSE2>(pairwise_consistency, nb_runs);
+    } else {
+        reportConsistencyLoop<graph_utils::PoseSE3>(pairwise_consistency, nb_runs);
+    }
+
+    return 0;
+}
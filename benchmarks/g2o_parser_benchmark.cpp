@@ -0,0 +1,191 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file g2o_parser_benchmark.cpp
+ *  \brief Throughput of the .g2o parsers.
+ */
+
+#include "graph_utils/graph_utils_functions.h"
+#include "graph_utils/g2o_parser.h"
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <fstream>
+#include <functional>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <map>
+
+namespace {
+
+/** Output of a parser */
+struct ParseResult {
+    size_t num_poses;
+    graph_utils::Transforms transforms;
+    graph_utils::LoopClosures loop_closures;
+    uint8_t nb_degree_freedom;
+};
+
+typedef std::function<uint8_t(const std::string&, size_t&, graph_utils::Transforms&,
+                              graph_utils::LoopClosures&, const bool&)> Parser;
+
+/** Writes the content of the input file replicated_factor times, with shifted pose IDs */
+void writeReplicatedFile(const std::string& input_file_name, const std::string& output_file_name, const size_t& replication_factor) {
+    std::ifstream input_file(input_file_name);
+    std::vector<std::string> lines;
+    std::string line;
+    size_t max_id = 0;
+    while (std::getline(input_file, line)) {
+        std::stringstream strstrm(line);
+        std::string token;
+        size_t i, j;
+        if (!(strstrm >> token >> i >> j)) {
+            continue;
+        }
+        max_id = std::max(max_id, std::max(i, j));
+        lines.push_back(line);
+    }
+
+    std::ofstream output_file(output_file_name);
+    for (size_t copy = 0; copy < replication_factor; copy++) {
+        const size_t offset = copy * (max_id + 1);
+        for (const auto& l: lines) {
+            std::stringstream strstrm(l);
+            std::string token, rest;
+            size_t i, j;
+            strstrm >> token >> i >> j;
+            std::getline(strstrm, rest);
+            output_file << token << " " << i + offset << " " << j + offset << rest << "\n";
+        }
+    }
+}
+
+size_t fileSize(const std::string& file_name) {
+    std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+    return file.tellg();
+}
+
+/** Parses the file nb_runs times and prints the throughput */
+ParseResult benchmarkParser(const std::string& name, const Parser& parser, const std::string& file_name,
+                            const bool& only_loop_closures, const int& nb_runs) {
+    ParseResult result;
+    double total_seconds = 0;
+    for (int run = 0; run < nb_runs; run++) {
+        result = ParseResult();
+        auto start = std::chrono::high_resolution_clock::now();
+        result.nb_degree_freedom = parser(file_name, result.num_poses, result.transforms, result.loop_closures, only_loop_closures);
+        auto finish = std::chrono::high_resolution_clock::now();
+        total_seconds += std::chrono::duration<double>(finish - start).count();
+    }
+    const double seconds = total_seconds / nb_runs;
+    const double megabytes = fileSize(file_name) / (1024.0 * 1024.0);
+    std::cout << "  " << name << " : " << seconds * 1000 << " ms | "
+              << megabytes / seconds << " MB/s | "
+              << result.transforms.transforms.size() / seconds << " edges/s" << std::endl;
+    return result;
+}
+
+bool isIdentical(const ParseResult& a, const ParseResult& b) {
+    if (a.num_poses != b.num_poses || a.nb_degree_freedom != b.nb_degree_freedom ||
+        a.loop_closures != b.loop_closures || a.transforms.start_id != b.transforms.start_id ||
+        a.transforms.end_id != b.transforms.end_id ||
+        a.transforms.transforms.size() != b.transforms.transforms.size()) {
+        return false;
+    }
+    for (size_t index = 0; index < a.transforms.transforms.size(); index++) {
+        const graph_utils::Transform t_a = a.transforms.transforms.at(index);
+        const graph_utils::Transform t_b = b.transforms.transforms.at(index);
+        const auto& pa = t_a.pose.pose;
+        const auto& pb = t_b.pose.pose;
+        if (t_a.i != t_b.i || t_a.j != t_b.j || t_a.is_loop_closure != t_b.is_loop_closure ||
+            pa.position.x != pb.position.x || pa.position.y != pb.position.y || pa.position.z != pb.position.z ||
+            pa.orientation.x != pb.orientation.x || pa.orientation.y != pb.orientation.y ||
+            pa.orientation.z != pb.orientation.z || pa.orientation.w != pb.orientation.w ||
+            t_a.pose.covariance != t_b.pose.covariance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Compares the flat transform store with the std::map previously used to store the transforms */
+void benchmarkStorage(const graph_utils::TransformStore& transforms) {
+    std::vector<graph_utils::Transform> edges;
+    edges.reserve(transforms.size());
+    for (size_t index = 0; index < transforms.size(); index++) {
+        edges.push_back(transforms.at(index));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::map<std::pair<size_t,size_t>, graph_utils::Transform> map;
+    for (const auto& edge: edges) {
+        map.emplace(std::make_pair(std::make_pair(edge.i, edge.j), edge));
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    const double map_ms = std::chrono::duration<double, std::milli>(finish - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    graph_utils::TransformStore store;
+    for (const auto& edge: edges) {
+        store.insert(edge);
+    }
+    finish = std::chrono::high_resolution_clock::now();
+    const double store_ms = std::chrono::duration<double, std::milli>(finish - start).count();
+
+    // Red-black tree node : color and 3 pointers, plus the allocator header
+    const size_t map_node_bytes = sizeof(std::map<std::pair<size_t,size_t>, graph_utils::Transform>::value_type) + 4 * sizeof(void*) + 16;
+    std::cout << "  storage of " << edges.size() << " transforms : std::map " << map_ms << " ms, "
+              << map_node_bytes << " bytes/edge (estimate) | flat store " << store_ms << " ms, "
+              << store.getMemoryUsage() / std::max<size_t>(1, edges.size()) << " bytes/edge" << std::endl;
+}
+
+void benchmarkFile(const std::string& file_name, const bool& only_loop_closures, const int& nb_runs) {
+    std::cout << file_name << " (" << fileSize(file_name) / 1024.0 << " KB)" << std::endl;
+    ParseResult reference = benchmarkParser("stream", graph_utils::parseG2ofile, file_name, only_loop_closures, nb_runs);
+    ParseResult mapped = benchmarkParser("mapped", graph_utils::parseG2ofileMapped, file_name, only_loop_closures, nb_runs);
+    std::cout << "  mapped output identical to stream output : " << (isIdentical(reference, mapped) ? "yes" : "NO") << std::endl;
+    benchmarkStorage(mapped.transforms.transforms);
+
+    // Parallel parser, doubling the number of threads up to the hardware concurrency
+    const size_t max_nb_threads = std::max<unsigned>(1, std::thread::hardware_concurrency());
+    for (size_t nb_threads = 1; ; nb_threads = std::min(2 * nb_threads, max_nb_threads)) {
+        Parser parser = [&](const std::string& f, size_t& n, graph_utils::Transforms& t, graph_utils::LoopClosures& l, const bool& o) {
+            return graph_utils::parseG2ofileParallel(f, n, t, l, o, nb_threads);
+        };
+        ParseResult parallel = benchmarkParser("parallel (" + std::to_string(nb_threads) + " threads)", parser, file_name, only_loop_closures, nb_runs);
+        std::cout << "  parallel output identical to stream output : " << (isIdentical(reference, parallel) ? "yes" : "NO") << std::endl;
+        if (nb_threads == max_nb_threads) {
+            break;
+        }
+    }
+}
+
+}
+
+/** \brief Benchmark of the .g2o parsers.
+ *
+ * Arguments : <.g2o file> [replication factor (default 100)] [number of runs (default 5)] [only loop closures (0 or 1)]
+ * The file is parsed as is, then replicated with shifted pose IDs to emulate a large log.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cout << "Please specify a .g2o file, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL.g2o" << std::endl;
+        return -1;
+    }
+    const std::string file_name = argv[1];
+    const size_t replication_factor = argc > 2 ? std::stoul(argv[2]) : 100;
+    const int nb_runs = argc > 3 ? std::stoi(argv[3]) : 5;
+    const bool only_loop_closures = argc > 4 ? std::stoi(argv[4]) != 0 : false;
+
+    benchmarkFile(file_name, only_loop_closures, nb_runs);
+
+    if (replication_factor > 1) {
+        const std::string replicated_file_name = file_name + ".replicated.g2o";
+        writeReplicatedFile(file_name, replicated_file_name, replication_factor);
+        benchmarkFile(replicated_file_name, only_loop_closures, nb_runs);
+        std::remove(replicated_file_name.c_str());
+    }
+
+    return 0;
+}
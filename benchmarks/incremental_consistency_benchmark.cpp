@@ -0,0 +1,190 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file incremental_consistency_benchmark.cpp
+ *  \brief Latency of the update of the consistency graph when new loop closures arrive.
+ */
+
+#include "graph_utils/graph_utils_functions.h"
+#include "graph_utils/pose_algebra.h"
+#include "pairwise_consistency/pairwise_consistency.h"
+#include "robot_local_map/robot_local_map.h"
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <algorithm>
+
+namespace {
+
+/** Number of synthetic loop closures added one at a time after the initial graph */
+const size_t NB_ADDED_LOOP_CLOSURES = 20;
+
+/** Checks that the persistent graph has the same edges as a graph computed from scratch */
+bool isIdentical(const graph_utils::DynamicConsistencyGraph& dynamic_graph, const graph_utils::ConsistencyGraph& reference_graph) {
+    const graph_utils::ConsistencyGraph compacted_graph(dynamic_graph);
+    return compacted_graph.getOffsets() == reference_graph.getOffsets() && compacted_graph.getNeighbors() == reference_graph.getNeighbors();
+}
+
+/** Transforms restricted to a list of loop closures */
+graph_utils::Transforms selectTransforms(const graph_utils::Transforms& transforms, const graph_utils::LoopClosures& loop_closures) {
+    graph_utils::Transforms result;
+    result.start_id = transforms.start_id;
+    result.end_id = transforms.end_id;
+    result.transforms.reserve(loop_closures.size());
+    for (const auto& loop_closure: loop_closures) {
+        result.transforms.insert(transforms.transforms.at(transforms.transforms.find(loop_closure)));
+    }
+    return result;
+}
+
+/**
+ * Synthetic loop closures between random poses of the two robots. The inliers agree with the frame
+ * change of the first real loop closure, the outliers with the frame change of a random pair of poses.
+ * All of them have the covariance of the first real loop closure.
+ */
+template <typename Pose>
+void generateLoopClosures(const graph_utils::Trajectory& trajectory_robot1, const graph_utils::Trajectory& trajectory_robot2,
+                          const graph_utils::Transform& reference, const size_t& nb_loop_closures, const double& inlier_ratio,
+                          graph_utils::LoopClosures& loop_closures, graph_utils::Transforms& transforms) {
+    const graph_utils::Trajectory* trajectories[2] = {&trajectory_robot1, &trajectory_robot2};
+    auto getPose = [&](const int& robot, const size_t& id) {
+        Pose pose;
+        graph_utils::fromPoseWithCovariance(trajectories[robot]->trajectory_poses[id - trajectories[robot]->start_id].pose, pose);
+        return pose;
+    };
+    const int reference_robot = graph_utils::isInTrajectory(trajectory_robot1, reference.i) ? 0 : 1;
+
+    // Frame change of the reference : Xi (+) Zik (+) Xk^-1
+    Pose measurement, frame_change, inverse_pose;
+    graph_utils::fromPoseWithCovariance(reference.pose, measurement);
+    graph_utils::compose(getPose(reference_robot, reference.i), measurement, frame_change);
+    graph_utils::inverse(getPose(1 - reference_robot, reference.j), inverse_pose);
+    graph_utils::compose(frame_change, inverse_pose, frame_change);
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> robot1_ids(trajectory_robot1.start_id, trajectory_robot1.end_id);
+    std::uniform_int_distribution<size_t> robot2_ids(trajectory_robot2.start_id, trajectory_robot2.end_id);
+    std::bernoulli_distribution is_inlier(inlier_ratio);
+    loop_closures.clear();
+    transforms.transforms.clear();
+    transforms.transforms.reserve(nb_loop_closures);
+    transforms.start_id = std::min(trajectory_robot1.start_id, trajectory_robot2.start_id);
+    transforms.end_id = std::max(trajectory_robot1.end_id, trajectory_robot2.end_id);
+    while (loop_closures.size() < nb_loop_closures) {
+        graph_utils::Transform transform;
+        transform.i = robot1_ids(generator);
+        transform.j = robot2_ids(generator);
+        transform.is_loop_closure = true;
+
+        // Zik = Xi^-1 (+) T (+) Xk
+        Pose pose = frame_change;
+        if (!is_inlier(generator)) {
+            graph_utils::inverse(getPose(1, robot2_ids(generator)), inverse_pose);
+            graph_utils::compose(getPose(0, robot1_ids(generator)), inverse_pose, pose);
+        }
+        graph_utils::inverse(getPose(0, transform.i), inverse_pose);
+        graph_utils::compose(inverse_pose, pose, pose);
+        graph_utils::compose(pose, getPose(1, transform.j), pose);
+        pose.covariance = measurement.covariance;
+        graph_utils::toPoseWithCovariance(pose, transform.pose);
+        if (transforms.transforms.insert(transform)) {
+            loop_closures.emplace_back(transform.i, transform.j);
+        }
+    }
+}
+
+/** Adds the last real loop closure to the graph of the others and checks the result against a full computation */
+void reportRealLoopClosures(const robot_local_map::RobotLocalMap& robot1_local_map, const robot_local_map::RobotLocalMap& robot2_local_map,
+                            const robot_local_map::RobotMeasurements& interrobot_measurements, const size_t& nb_threads) {
+    const graph_utils::LoopClosures& loop_closures = interrobot_measurements.getLoopClosures();
+    const graph_utils::LoopClosures previous_loop_closures(loop_closures.begin(), loop_closures.end() - 1);
+    const graph_utils::LoopClosures new_loop_closures(loop_closures.end() - 1, loop_closures.end());
+
+    pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+        selectTransforms(interrobot_measurements.getTransforms(), previous_loop_closures), previous_loop_closures,
+        robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom(), nb_threads);
+    auto start = std::chrono::high_resolution_clock::now();
+    pairwise_consistency.updateConsistencyGraph();
+    auto middle = std::chrono::high_resolution_clock::now();
+    pairwise_consistency.addLoopClosures(new_loop_closures, selectTransforms(interrobot_measurements.getTransforms(), new_loop_closures));
+    auto finish = std::chrono::high_resolution_clock::now();
+
+    pairwise_consistency::PairwiseConsistency reference(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+        interrobot_measurements.getTransforms(), loop_closures, robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(),
+        robot1_local_map.getNbDegreeFreedom(), nb_threads);
+    std::cout << loop_closures.size() << " loop closures : graph of the first " << previous_loop_closures.size() << " in "
+              << std::chrono::duration<double, std::milli>(middle - start).count() << " ms, last one added in "
+              << std::chrono::duration<double, std::milli>(finish - middle).count() << " ms, "
+              << pairwise_consistency.getConsistencyGraph().getNbEdges() << " edges"
+              << (isIdentical(pairwise_consistency.getConsistencyGraph(), reference.computeConsistencyGraph()) ? ", identical" : ", DIFFERENT")
+              << " to the full computation" << std::endl;
+}
+
+/** Latency of the addition of single synthetic loop closures to a graph of nb_loop_closures */
+template <typename Pose>
+void reportSyntheticLoopClosures(const robot_local_map::RobotLocalMap& robot1_local_map, const robot_local_map::RobotLocalMap& robot2_local_map,
+                                 const robot_local_map::RobotMeasurements& interrobot_measurements, const size_t& nb_loop_closures,
+                                 const double& inlier_ratio, const size_t& nb_threads) {
+    const graph_utils::Transforms& interrobot_transforms = interrobot_measurements.getTransforms();
+    graph_utils::LoopClosures loop_closures;
+    graph_utils::Transforms transforms;
+    generateLoopClosures<Pose>(robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(),
+                               interrobot_transforms.transforms.at(interrobot_transforms.transforms.find(interrobot_measurements.getLoopClosures().front())),
+                               nb_loop_closures + NB_ADDED_LOOP_CLOSURES, inlier_ratio, loop_closures, transforms);
+    const graph_utils::LoopClosures initial_loop_closures(loop_closures.begin(), loop_closures.begin() + nb_loop_closures);
+
+    pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+        selectTransforms(transforms, initial_loop_closures), initial_loop_closures,
+        robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom(), nb_threads);
+    auto start = std::chrono::high_resolution_clock::now();
+    pairwise_consistency.updateConsistencyGraph();
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::cout << nb_loop_closures << " synthetic loop closures (" << inlier_ratio * 100 << "% inliers) : initial graph in "
+              << std::chrono::duration<double, std::milli>(finish - start).count() << " ms, "
+              << pairwise_consistency.getConsistencyGraph().getNbEdges() << " edges" << std::endl;
+
+    double total_milliseconds = 0, max_milliseconds = 0;
+    for (size_t index = nb_loop_closures; index < loop_closures.size(); index++) {
+        const graph_utils::LoopClosures new_loop_closures(1, loop_closures[index]);
+        const graph_utils::Transforms new_transforms = selectTransforms(transforms, new_loop_closures);
+        start = std::chrono::high_resolution_clock::now();
+        pairwise_consistency.addLoopClosures(new_loop_closures, new_transforms);
+        finish = std::chrono::high_resolution_clock::now();
+        const double milliseconds = std::chrono::duration<double, std::milli>(finish - start).count();
+        total_milliseconds += milliseconds;
+        max_milliseconds = std::max(max_milliseconds, milliseconds);
+    }
+    std::cout << "  single loop closure added in " << total_milliseconds / NB_ADDED_LOOP_CLOSURES << " ms on average, "
+              << max_milliseconds << " ms at most, " << pairwise_consistency.getConsistencyGraph().getNbEdges() << " edges" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "Please specify 3 input files, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL_robot1.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_robot2.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures_outliers.g2o" << std::endl;
+        return -1;
+    }
+    const size_t nb_loop_closures = argc > 4 ? std::stoul(argv[4]) : 10000;
+    const double inlier_ratio = argc > 5 ? std::stod(argv[5]) : 0.1;
+    const size_t nb_threads = argc > 6 ? std::stoul(argv[6]) : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    auto robot1_local_map = robot_local_map::RobotLocalMap(argv[1]);
+    auto robot2_local_map = robot_local_map::RobotLocalMap(argv[2]);
+    auto interrobot_measurements = robot_local_map::RobotMeasurements(argv[3], true);
+
+    reportRealLoopClosures(robot1_local_map, robot2_local_map, interrobot_measurements, nb_threads);
+    if (robot1_local_map.getNbDegreeFreedom() == 3) {
+        reportSyntheticLoopClosures<graph_utils::PoseSE2>(robot1_local_map, robot2_local_map, interrobot_measurements,
+                                                          nb_loop_closures, inlier_ratio, nb_threads);
+    } else {
+        reportSyntheticLoopClosures<graph_utils::PoseSE3>(robot1_local_map, robot2_local_map, interrobot_measurements,
+                                                          nb_loop_closures, inlier_ratio, nb_threads);
+    }
+
+    return 0;
+}
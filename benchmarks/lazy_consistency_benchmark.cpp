@@ -0,0 +1,130 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file lazy_consistency_benchmark.cpp
+ *  \brief Evaluations of pairs of loop closures and time of the maximum clique, computed eagerly and lazily.
+ */
+
+#include "graph_utils/graph_utils_functions.h"
+#include "pairwise_consistency/pairwise_consistency.h"
+#include "pairwise_consistency/consistency_oracle.h"
+#include "max_clique_solver/lazy_max_clique.h"
+#include "max_clique_solver/fmc_graph.h"
+#include "robot_local_map/robot_local_map.h"
+#include "findClique.h"
+#include <string>
+#include <iostream>
+#include <chrono>
+
+namespace {
+
+/** Checks that the vertices form a clique of the consistency graph */
+bool isClique(const graph_utils::ConsistencyGraph& consistency_graph, const std::vector<uint32_t>& clique) {
+    for (size_t first = 0; first < clique.size(); first++) {
+        for (size_t second = first + 1; second < clique.size(); second++) {
+            if (!consistency_graph.hasEdge(clique[first], clique[second])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** Maximum clique of the loop closures of a file, with the consistency graph computed beforehand and on demand */
+void reportLazyConsistency(const robot_local_map::RobotLocalMap& robot1_local_map, const robot_local_map::RobotLocalMap& robot2_local_map,
+                           const std::string& interrobot_file_name, const int& nb_runs) {
+    auto interrobot_measurements = robot_local_map::RobotMeasurements(interrobot_file_name, true);
+    pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+        interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+        robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom());
+
+    // Eager : whole consistency graph, then maximum clique of the graph
+    graph_utils::ConsistencyGraph consistency_graph;
+    int eager_max_clique_size = 0;
+    double graph_milliseconds = 0, clique_milliseconds = 0;
+    for (int run = 0; run < nb_runs; run++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        consistency_graph = pairwise_consistency.computeConsistencyGraph();
+        auto middle = std::chrono::high_resolution_clock::now();
+        FMC::CGraphIO gio;
+        max_clique_solver::loadConsistencyGraph(consistency_graph, gio);
+        std::vector<int> max_clique_data;
+        eager_max_clique_size = FMC::maxClique(gio, 0, max_clique_data);
+        auto finish = std::chrono::high_resolution_clock::now();
+        graph_milliseconds += std::chrono::duration<double, std::milli>(middle - start).count() / nb_runs;
+        clique_milliseconds += std::chrono::duration<double, std::milli>(finish - middle).count() / nb_runs;
+    }
+    const size_t nb_pairs = pairwise_consistency.getStatistics().nb_pairs;
+
+    // Same search as the lazy one, on the whole consistency graph
+    std::vector<uint32_t> max_clique;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        max_clique_solver::LazyMaxClique search(consistency_graph.getNbVertices(), [&consistency_graph](const size_t& u, const size_t& v) {
+            return consistency_graph.hasEdge(u, v);
+        });
+        search.findMaxClique(0, max_clique);
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    const double search_milliseconds = std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+
+    // Lazy : the search queries the oracle, the cache starts empty at each run
+    size_t nb_evaluations = 0, nb_queries = 0, nb_expanded_nodes = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        pairwise_consistency::ConsistencyOracle oracle(pairwise_consistency);
+        max_clique_solver::LazyMaxClique search(oracle.getNbVertices(), [&oracle](const size_t& u, const size_t& v) {
+            return oracle.isConsistent(u, v);
+        });
+        search.findMaxClique(0, max_clique);
+        nb_evaluations = oracle.getNbEvaluations();
+        nb_queries = oracle.getNbQueries();
+        nb_expanded_nodes = search.getNbExpandedNodes();
+    }
+    finish = std::chrono::high_resolution_clock::now();
+    const double lazy_milliseconds = std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+
+    std::cout << interrobot_file_name << " : " << consistency_graph.getNbVertices() << " loop closures, "
+              << consistency_graph.getNbEdges() << " consistent pairs" << std::endl;
+    std::cout << "  eager : " << nb_pairs << " pairs evaluated, " << graph_milliseconds + clique_milliseconds << " ms ("
+              << graph_milliseconds << " ms for the graph, " << clique_milliseconds << " ms for the clique, "
+              << search_milliseconds << " ms for the lazy search on the graph), maximum clique " << eager_max_clique_size << std::endl;
+    std::cout << "  lazy : " << nb_evaluations << " pairs evaluated (" << 100.0 * nb_evaluations / std::max<size_t>(1, nb_pairs) << "%), "
+              << nb_queries << " queries, " << nb_expanded_nodes << " nodes, " << lazy_milliseconds << " ms (x"
+              << (graph_milliseconds + clique_milliseconds) / lazy_milliseconds << " faster), maximum clique " << max_clique.size()
+              << ((int) max_clique.size() == eager_max_clique_size && isClique(consistency_graph, max_clique) ? ", valid" : ", INVALID") << std::endl;
+}
+
+}
+
+/** \brief Benchmark of the lazy evaluation of the consistency by the maximum clique search.
+ *
+ * Arguments : <trajectory robot1 file> <trajectory robot2 file> <inter robot loop closures file>... [number of runs (default 10)]
+ * For each file of inter robot loop closures, e.g. one with mostly inliers and one with mostly outliers, compares the
+ * number of pairs evaluated and the time of the maximum clique when the consistency graph is computed beforehand
+ * and when the search evaluates the pairs on demand through the consistency oracle.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "Please specify at least 3 input files, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL_robot1.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_robot2.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures_outliers.g2o" << std::endl;
+        return -1;
+    }
+    int nb_files = argc;
+    int nb_runs = 10;
+    const std::string last_argument = argv[argc - 1];
+    if (last_argument.find_first_not_of("0123456789") == std::string::npos) {
+        nb_runs = std::stoi(last_argument);
+        nb_files--;
+    }
+
+    auto robot1_local_map = robot_local_map::RobotLocalMap(argv[1]);
+    auto robot2_local_map = robot_local_map::RobotLocalMap(argv[2]);
+    for (int arg = 3; arg < nb_files; arg++) {
+        reportLazyConsistency(robot1_local_map, robot2_local_map, argv[arg], nb_runs);
+    }
+
+    return 0;
+}
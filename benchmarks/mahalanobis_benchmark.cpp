@@ -0,0 +1,188 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file mahalanobis_benchmark.cpp
+ *  \brief Per-pair cost of the squared Mahalanobis distance of the consistency test.
+ */
+
+#include "graph_utils/graph_utils_functions.h"
+#include "graph_utils/information_form.h"
+#include "pairwise_consistency/pairwise_consistency.h"
+#include "robot_local_map/robot_local_map.h"
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace {
+
+typedef Eigen::Matrix<double, 6, 1> Vector6d;
+typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+
+/** Variance given to z, roll and pitch when planar measurements are processed in 3D */
+const double PLANAR_EMBEDDING_VARIANCE = 1e-2;
+
+/** Copy of planar measurements, with a small variance on z, roll and pitch so that they can be processed in 3D */
+graph_utils::Transforms embedIn3D(const graph_utils::Transforms& transforms) {
+    graph_utils::Transforms result;
+    result.start_id = transforms.start_id;
+    result.end_id = transforms.end_id;
+    result.transforms.reserve(transforms.transforms.size());
+    for (size_t index = 0; index < transforms.transforms.size(); index++) {
+        graph_utils::Transform transform = transforms.transforms.at(index);
+        for (const int& k: {2, 3, 4}) {
+            transform.pose.covariance[k * 6 + k] = PLANAR_EMBEDDING_VARIANCE;
+        }
+        result.transforms.insert(transform);
+    }
+    return result;
+}
+
+/** Residual (x, y, qz) of a planar consistency pose and its covariance, as in the consistency test */
+void getResidual(const graph_utils::PoseSE2& pose, Eigen::Vector3d& residual, Eigen::Matrix3d& covariance) {
+    residual << pose.mean(0), pose.mean(1), std::sin(pose.mean(2) / 2);
+    covariance = pose.covariance;
+}
+
+/** Residual (x, y, z, qz, qy, qx) of a 3D consistency pose and its covariance, as in the consistency test */
+void getResidual(const graph_utils::PoseSE3& pose, Vector6d& residual, Matrix6d& covariance) {
+    geometry_msgs::Quaternion q;
+    graph_utils::getQuaternion(pose, q);
+    residual << pose.translation, q.z, q.y, q.x;
+    covariance = pose.covariance;
+}
+
+/** Consistency poses (abZik^-1 + aXi^-1) + (aXj + abZjl + bXl^-1) + bXk of all the inter-robot pairs of loop closures,
+ *  composed from the loop closure table of the consistency test */
+template <typename Pose, int Dim>
+void collectConsistencyLoops(const pairwise_consistency::PairwiseConsistency& pairwise_consistency,
+                             std::vector<Eigen::Matrix<double, Dim, 1>>& residuals,
+                             std::vector<Eigen::Matrix<double, Dim, Dim>, Eigen::aligned_allocator<Eigen::Matrix<double, Dim, Dim>>>& covariances) {
+    const auto& poses = pairwise_consistency.template getLoopClosureTable<Pose>();
+    const auto& entries = poses.loop_closure_entries;
+    for (size_t u = 0; u < entries.size(); u++) {
+        for (size_t v = u + 1; v < entries.size(); v++) {
+            const uint8_t orientations = entries[u].orientations & entries[v].orientations;
+            if (orientations == 0) {
+                continue;
+            }
+            const int robot_a = (orientations & pairwise_consistency::LoopClosureEntry::ROBOT1_TO_ROBOT2) ? 0 : 1;
+            const int robot_b = 1 - robot_a;
+            Pose row_column, consistency_pose;
+            graph_utils::compose(poses.row_terms[robot_a][u], poses.column_terms[robot_a][v], row_column);
+            graph_utils::compose(row_column, poses.trajectories[robot_b][entries[u].second_indexes[robot_b]], consistency_pose);
+
+            Eigen::Matrix<double, Dim, 1> residual;
+            Eigen::Matrix<double, Dim, Dim> covariance;
+            getResidual(consistency_pose, residual, covariance);
+            residuals.push_back(residual);
+            covariances.push_back(covariance);
+        }
+    }
+}
+
+template <int Dim, typename DistanceFunction>
+double timePerPair(const std::vector<Eigen::Matrix<double, Dim, 1>>& residuals,
+                   const std::vector<Eigen::Matrix<double, Dim, Dim>, Eigen::aligned_allocator<Eigen::Matrix<double, Dim, Dim>>>& covariances,
+                   const int& nb_runs, std::vector<double>& distances, DistanceFunction distance) {
+    distances.resize(residuals.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        for (size_t p = 0; p < residuals.size(); p++) {
+            distances[p] = distance(residuals[p], covariances[p]);
+        }
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(finish - start).count() / (nb_runs * residuals.size());
+}
+
+/** Times both distances on the consistency poses of the loop closure table of the pose type, and compares the decisions */
+template <typename Pose, int Dim>
+void reportDistances(const std::string& name, const pairwise_consistency::PairwiseConsistency& pairwise_consistency, const int& nb_runs) {
+    std::vector<Eigen::Matrix<double, Dim, 1>> residuals;
+    std::vector<Eigen::Matrix<double, Dim, Dim>, Eigen::aligned_allocator<Eigen::Matrix<double, Dim, Dim>>> covariances;
+    collectConsistencyLoops<Pose, Dim>(pairwise_consistency, residuals, covariances);
+    if (residuals.empty()) {
+        std::cout << name << " : no pair of inter-robot loop closures to evaluate." << std::endl;
+        return;
+    }
+
+    std::vector<double> explicit_distances, information_distances;
+    const double explicit_ns = timePerPair<Dim>(residuals, covariances, nb_runs, explicit_distances,
+        [](const Eigen::Matrix<double, Dim, 1>& r, const Eigen::Matrix<double, Dim, Dim>& c) {
+            return graph_utils::squaredMahalanobisDistanceExplicitInverse<Dim>(r, c); });
+    const double information_ns = timePerPair<Dim>(residuals, covariances, nb_runs, information_distances,
+        [](const Eigen::Matrix<double, Dim, 1>& r, const Eigen::Matrix<double, Dim, Dim>& c) {
+            return graph_utils::squaredMahalanobisDistance<Dim>(r, c); });
+
+    // The decisions are only meaningful if the distances are, the covariances which fall back on the explicit inverse are counted
+    const double threshold = pairwise_consistency.getChiSquaredThreshold();
+    size_t nb_mismatches = 0, nb_consistent_pairs = 0, nb_not_positive_definite = 0, nb_not_finite = 0;
+    double max_relative_difference = 0;
+    for (size_t p = 0; p < residuals.size(); p++) {
+        nb_mismatches += (explicit_distances[p] < threshold) != (information_distances[p] < threshold);
+        nb_consistent_pairs += information_distances[p] < threshold;
+        nb_not_positive_definite += Eigen::LLT<Eigen::Matrix<double, Dim, Dim>>(covariances[p]).info() != Eigen::Success;
+        if (!std::isfinite(explicit_distances[p]) || !std::isfinite(information_distances[p])) {
+            nb_not_finite++;
+        } else {
+            max_relative_difference = std::max(max_relative_difference, std::abs(explicit_distances[p] - information_distances[p]) /
+                                                                        std::max(explicit_distances[p], 1e-12));
+        }
+    }
+
+    const double ratio = explicit_ns / information_ns;
+    std::cout << name << " : " << residuals.size() << " pairs of loop closures, " << Dim << "x" << Dim << " covariances, "
+              << nb_not_positive_definite << " not positive definite, " << nb_not_finite << " non-finite distances" << std::endl;
+    std::cout << "  explicit inverse   : " << explicit_ns << " ns/pair" << std::endl;
+    std::cout << "  information form   : " << information_ns << " ns/pair (x"
+              << (ratio >= 1 ? ratio : 1 / ratio) << (ratio >= 1 ? " faster)" : " slower)") << std::endl;
+    std::cout << "  consistent pairs : " << nb_consistent_pairs << ", decisions that differ : " << nb_mismatches
+              << ", largest relative difference : " << max_relative_difference << std::endl;
+}
+
+}
+
+/** \brief Benchmark of the squared Mahalanobis distance of the pairwise consistency test.
+ *
+ * Arguments : <trajectory robot1 file> <trajectory robot2 file> <inter robot loop closures file> [number of runs (default 100)]
+ * Compares the explicit inverse of the covariance with the information form (Cholesky factor and triangular solve)
+ * on the residuals and covariances evaluated by the consistency test, composed from its loop closure table, and
+ * counts the pairs on which the consistency decisions differ. Planar measurements are also processed in 3D, after
+ * giving a small variance to z, roll and pitch, to compare the 6x6 covariances.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "Please specify 3 input files, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL_robot1.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_robot2.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures_outliers.g2o" << std::endl;
+        return -1;
+    }
+    const int nb_runs = argc > 4 ? std::stoi(argv[4]) : 100;
+
+    auto robot1_local_map = robot_local_map::RobotLocalMap(argv[1]);
+    auto robot2_local_map = robot_local_map::RobotLocalMap(argv[2]);
+    auto interrobot_measurements = robot_local_map::RobotMeasurements(argv[3], true);
+    const uint8_t nb_degree_freedom = robot1_local_map.getNbDegreeFreedom();
+
+    pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+        interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+        robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), nb_degree_freedom);
+    if (nb_degree_freedom == 3) {
+        reportDistances<graph_utils::PoseSE2, 3>("SE2", pairwise_consistency, nb_runs);
+
+        const graph_utils::Transforms transforms_robot1 = embedIn3D(robot1_local_map.getTransforms());
+        const graph_utils::Transforms transforms_robot2 = embedIn3D(robot2_local_map.getTransforms());
+        const graph_utils::Transforms transforms_interrobot = embedIn3D(interrobot_measurements.getTransforms());
+        pairwise_consistency::PairwiseConsistency pairwise_consistency_3d(transforms_robot1, transforms_robot2,
+            transforms_interrobot, interrobot_measurements.getLoopClosures(),
+            graph_utils::buildTrajectory(transforms_robot1), graph_utils::buildTrajectory(transforms_robot2), 6);
+        reportDistances<graph_utils::PoseSE3, 6>("SE3, planar measurements embedded in 3D", pairwise_consistency_3d, nb_runs);
+    } else {
+        reportDistances<graph_utils::PoseSE3, 6>("SE3", pairwise_consistency, nb_runs);
+    }
+
+    return 0;
+}
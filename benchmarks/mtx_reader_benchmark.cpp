@@ -0,0 +1,135 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file mtx_reader_benchmark.cpp
+ *  \brief Time of the MatrixMarket readers of the maximum clique solver on large graphs.
+ */
+
+#include "graphIO.h"
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+/** Neighbors of a vertex with the values of the edges, sorted by neighbor */
+typedef std::vector<std::pair<int, double>> Neighbors;
+
+/**
+ * Writes a random symmetric graph in the format of printConsistencyGraph, with nb_entries entries between random
+ * vertices : the same edge can be written several times, in both orientations, and a few entries are self loops
+ */
+void writeRandomGraph(const std::string& file_name, const size_t& nb_vertices, const size_t& nb_entries, const bool& pattern) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> vertex(0, nb_vertices - 1);
+    std::uniform_real_distribution<double> value(0, 1);
+    std::vector<std::pair<size_t, size_t>> edges(nb_entries);
+    for (auto& edge: edges) {
+        edge = std::make_pair(vertex(generator), vertex(generator));
+    }
+
+    std::ofstream output_file(file_name);
+    output_file << "%%MatrixMarket matrix coordinate " << (pattern ? "pattern" : "real") << " symmetric\n";
+    output_file << "% random graph\n";
+    output_file << nb_vertices << " " << nb_vertices << " " << edges.size() << "\n";
+    for (const auto& edge: edges) {
+        output_file << edge.first + 1 << " " << edge.second + 1;
+        if (!pattern) {
+            output_file << " " << value(generator);
+        }
+        output_file << "\n";
+    }
+}
+
+/** Adjacency lists of the graph read, sorted since the readers do not order the neighbors the same way */
+std::vector<Neighbors> getAdjacency(FMC::CGraphIO& graph) {
+    const std::vector<int>& vertices = *graph.GetVerticesPtr();
+    const std::vector<int>& edges = *graph.GetEdgesPtr();
+    std::vector<Neighbors> result(vertices.size() - 1);
+    for (size_t vertex = 0; vertex + 1 < vertices.size(); vertex++) {
+        for (int k = vertices[vertex]; k < vertices[vertex + 1]; k++) {
+            result[vertex].emplace_back(edges[k], graph.m_vd_Values.empty() ? 0 : graph.m_vd_Values[k]);
+        }
+        std::sort(result[vertex].begin(), result[vertex].end());
+    }
+    return result;
+}
+
+size_t fileSize(const std::string& file_name) {
+    std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+    return file.tellg();
+}
+
+/** Reads the file with the stream reader and the mapped reader, and compares the graphs */
+void benchmarkFile(const std::string& file_name, const int& nb_runs) {
+    double stream_milliseconds = 0, mapped_milliseconds = 0;
+    std::unique_ptr<FMC::CGraphIO> stream_graph, mapped_graph;
+    for (int run = 0; run < nb_runs; run++) {
+        stream_graph.reset(new FMC::CGraphIO());
+        auto start = std::chrono::high_resolution_clock::now();
+        stream_graph->ReadMatrixMarketAdjacencyGraph(file_name);
+        auto finish = std::chrono::high_resolution_clock::now();
+        stream_milliseconds += std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+
+        mapped_graph.reset(new FMC::CGraphIO());
+        start = std::chrono::high_resolution_clock::now();
+        mapped_graph->ReadMatrixMarketAdjacencyGraphMapped(file_name);
+        finish = std::chrono::high_resolution_clock::now();
+        mapped_milliseconds += std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+    }
+
+    const double megabytes = fileSize(file_name) / (1024.0 * 1024.0);
+    std::cout << file_name << " : " << mapped_graph->GetVertexCount() << " vertices, " << mapped_graph->GetEdgeCount()
+              << " edges, " << megabytes << " MB" << std::endl;
+    std::cout << "  stream reader : " << stream_milliseconds << " ms | " << megabytes * 1000 / stream_milliseconds << " MB/s" << std::endl;
+    std::cout << "  mapped reader : " << mapped_milliseconds << " ms | " << megabytes * 1000 / mapped_milliseconds << " MB/s (x"
+              << stream_milliseconds / mapped_milliseconds << ")" << std::endl;
+    const bool identical = getAdjacency(*stream_graph) == getAdjacency(*mapped_graph) &&
+                           stream_graph->GetMaximumVertexDegree() == mapped_graph->GetMaximumVertexDegree();
+    std::cout << "  mapped graph identical to stream graph : " << (identical ? "yes" : "NO") << std::endl;
+}
+
+}
+
+/** \brief Benchmark of the MatrixMarket readers of the maximum clique solver.
+ *
+ * Arguments : [.mtx file]... [number of runs (default 1)]
+ * Reads the given files, or random graphs if none is given : a dense one, as the consistency graphs of
+ * loop closures with many inliers, and a large sparse one, both with duplicate edges and self loops.
+ */
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> file_names;
+    int nb_runs = 1;
+    for (int arg = 1; arg < argc; arg++) {
+        const std::string argument = argv[arg];
+        if (argument.size() > 4 && argument.compare(argument.size() - 4, 4, ".mtx") == 0) {
+            file_names.push_back(argument);
+        } else {
+            nb_runs = std::max(1, std::stoi(argument));
+        }
+    }
+
+    if (!file_names.empty()) {
+        for (const auto& file_name: file_names) {
+            benchmarkFile(file_name, nb_runs);
+        }
+        return 0;
+    }
+
+    const std::string dense_file_name = "mtx_reader_benchmark_dense.mtx";
+    writeRandomGraph(dense_file_name, 2000, 1000000, false);
+    benchmarkFile(dense_file_name, nb_runs);
+    std::remove(dense_file_name.c_str());
+
+    const std::string sparse_file_name = "mtx_reader_benchmark_sparse.mtx";
+    writeRandomGraph(sparse_file_name, 1000000, 10000000, true);
+    benchmarkFile(sparse_file_name, nb_runs);
+    std::remove(sparse_file_name.c_str());
+
+    return 0;
+}
@@ -0,0 +1,178 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file odometry_tree_benchmark.cpp
+ *  \brief Cost and covariance of the relative poses composed from the odometry tree, and effect on the consistency test.
+ */
+
+#include "graph_utils/graph_utils_functions.h"
+#include "graph_utils/pose_algebra.h"
+#include "graph_utils/odometry_tree.h"
+#include "pairwise_consistency/pairwise_consistency.h"
+#include "robot_local_map/robot_local_map.h"
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+namespace {
+
+/** Number of random relative pose queries */
+const size_t NB_QUERIES = 200;
+
+/** Odometry of a trajectory repeated replication_factor times, to obtain a long trajectory */
+graph_utils::Transforms replicateOdometry(const graph_utils::Transforms& transforms, const size_t& nb_measurements,
+                                          const size_t& replication_factor) {
+    graph_utils::Transforms result;
+    result.start_id = 0;
+    result.end_id = nb_measurements * replication_factor;
+    result.transforms.reserve(result.end_id);
+    for (size_t id = 0; id < result.end_id; id++) {
+        const size_t original_id = transforms.start_id + id % nb_measurements;
+        graph_utils::Transform transform;
+        transform.i = id;
+        transform.j = id + 1;
+        transform.pose = transforms.transforms.getPose(transforms.transforms.find(original_id, original_id + 1));
+        transform.is_loop_closure = false;
+        result.transforms.insert(transform);
+    }
+    return result;
+}
+
+/** Relative pose Xi^-1 + Xj composed sequentially from the odometry between the poses, O(|j - i|) */
+template <typename Pose>
+void composeSequentially(const graph_utils::Transforms& transforms, const size_t& i, const size_t& j, Pose& result) {
+    geometry_msgs::PoseWithCovariance identity;
+    identity.pose.orientation.w = 1;
+    graph_utils::fromPoseWithCovariance(identity, result);
+    Pose measurement, composition;
+    for (size_t id = transforms.start_id + std::min(i, j); id < transforms.start_id + std::max(i, j); id++) {
+        graph_utils::fromPoseWithCovariance(transforms.transforms.getPose(transforms.transforms.find(id, id + 1)), measurement);
+        graph_utils::compose(result, measurement, composition);
+        result = composition;
+    }
+    if (i > j) {
+        graph_utils::inverse(result, composition);
+        result = composition;
+    }
+}
+
+/** Relative poses of random pairs of poses : sequentially, with the tree, and from the absolute poses */
+template <typename Pose>
+void reportRelativePoses(const std::string& name, const graph_utils::Transforms& transforms) {
+    auto start = std::chrono::high_resolution_clock::now();
+    const graph_utils::OdometryTree<Pose> tree(transforms);
+    auto finish = std::chrono::high_resolution_clock::now();
+    const double build_milliseconds = std::chrono::duration<double, std::milli>(finish - start).count();
+
+    const graph_utils::Trajectory trajectory = graph_utils::buildTrajectory(transforms);
+    std::vector<Pose, Eigen::aligned_allocator<Pose>> absolute_poses(trajectory.trajectory_poses.size());
+    for (size_t index = 0; index < absolute_poses.size(); index++) {
+        graph_utils::fromPoseWithCovariance(trajectory.trajectory_poses[index].pose, absolute_poses[index]);
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> indexes(0, tree.getNbPoses() - 1);
+    std::vector<std::pair<size_t, size_t>> queries(NB_QUERIES);
+    for (auto& query: queries) {
+        query = std::make_pair(indexes(generator), indexes(generator));
+    }
+    std::vector<Pose, Eigen::aligned_allocator<Pose>> sequential(NB_QUERIES), from_tree(NB_QUERIES), from_absolute(NB_QUERIES);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t query = 0; query < NB_QUERIES; query++) {
+        composeSequentially(transforms, queries[query].first, queries[query].second, sequential[query]);
+    }
+    auto middle = std::chrono::high_resolution_clock::now();
+    for (size_t query = 0; query < NB_QUERIES; query++) {
+        tree.getRelativePose(queries[query].first, queries[query].second, from_tree[query]);
+    }
+    finish = std::chrono::high_resolution_clock::now();
+    const double sequential_nanoseconds = std::chrono::duration<double, std::nano>(middle - start).count() / NB_QUERIES;
+    const double tree_nanoseconds = std::chrono::duration<double, std::nano>(finish - middle).count() / NB_QUERIES;
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t query = 0; query < NB_QUERIES; query++) {
+        graph_utils::inverseCompose(absolute_poses[queries[query].second], absolute_poses[queries[query].first], from_absolute[query]);
+    }
+    finish = std::chrono::high_resolution_clock::now();
+    const double absolute_nanoseconds = std::chrono::duration<double, std::nano>(finish - start).count() / NB_QUERIES;
+
+    // Difference of the tree with the sequential composition, and excess of covariance of the absolute poses
+    double max_difference = 0, trace_ratio = 0;
+    for (size_t query = 0; query < NB_QUERIES; query++) {
+        const double scale = std::max(1e-12, sequential[query].covariance.cwiseAbs().maxCoeff());
+        max_difference = std::max(max_difference, (from_tree[query].covariance - sequential[query].covariance).cwiseAbs().maxCoeff() / scale);
+        if (queries[query].first != queries[query].second) {
+            trace_ratio += from_absolute[query].covariance.trace() / sequential[query].covariance.trace() / NB_QUERIES;
+        }
+    }
+
+    std::cout << name << " : " << tree.getNbPoses() << " poses, tree built in " << build_milliseconds << " ms, "
+              << tree.getMemoryUsage() / 1024.0 << " KiB" << std::endl;
+    std::cout << "  sequential composition of the odometry : " << sequential_nanoseconds << " ns/query" << std::endl;
+    std::cout << "  odometry tree : " << tree_nanoseconds << " ns/query (x" << sequential_nanoseconds / tree_nanoseconds
+              << "), largest relative difference of the covariance " << max_difference << std::endl;
+    std::cout << "  absolute poses : " << absolute_nanoseconds << " ns/query, covariance trace x" << trace_ratio
+              << " on average (shared history counted twice)" << std::endl;
+}
+
+/** Consistency graph with the relative poses from the absolute poses and from the odometry */
+void reportConsistency(const robot_local_map::RobotLocalMap& robot1_local_map, const robot_local_map::RobotLocalMap& robot2_local_map,
+                       const robot_local_map::RobotMeasurements& interrobot_measurements) {
+    for (const bool use_odometry_relative_poses: {false, true}) {
+        pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+            interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+            robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom(), 1,
+            true, use_odometry_relative_poses);
+        auto start = std::chrono::high_resolution_clock::now();
+        const graph_utils::ConsistencyGraph consistency_graph = pairwise_consistency.computeConsistencyGraph();
+        auto finish = std::chrono::high_resolution_clock::now();
+        std::cout << (use_odometry_relative_poses ? "  relative poses from the odometry : " : "  relative poses from the absolute poses : ")
+                  << consistency_graph.getNbEdges() << " consistent pairs out of " << pairwise_consistency.getStatistics().nb_interrobot_pairs
+                  << ", " << std::chrono::duration<double, std::milli>(finish - start).count() << " ms" << std::endl;
+        // Only the 3D relative poses are memoized
+        if (use_odometry_relative_poses && robot1_local_map.getNbDegreeFreedom() == 6) {
+            const auto& cache = pairwise_consistency.getLoopClosureTable<graph_utils::PoseSE3>().relative_poses;
+            std::cout << "    cache of the relative poses : " << cache.getNbHits() << " hits, " << cache.getNbMisses() << " misses" << std::endl;
+        }
+    }
+}
+
+}
+
+/** \brief Benchmark of the relative poses composed from the odometry tree.
+ *
+ * Arguments : <trajectory robot1 file> <trajectory robot2 file> <inter robot loop closures file> [replication factor (default 100)]
+ * Compares the relative poses of random pairs of poses of the first trajectory, and of its odometry repeated to form
+ * a long trajectory, composed sequentially, with the odometry tree and from the absolute poses. Then compares the
+ * consistency graphs with the relative poses of the pairs from the absolute poses and from the odometry.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "Please specify 3 input files, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL_robot1.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_robot2.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures_outliers.g2o" << std::endl;
+        return -1;
+    }
+    const size_t replication_factor = argc > 4 ? std::stoul(argv[4]) : 100;
+
+    auto robot1_local_map = robot_local_map::RobotLocalMap(argv[1]);
+    auto robot2_local_map = robot_local_map::RobotLocalMap(argv[2]);
+    auto interrobot_measurements = robot_local_map::RobotMeasurements(argv[3], true);
+    const graph_utils::Transforms& transforms = robot1_local_map.getTransforms();
+    const size_t nb_measurements = robot1_local_map.getTrajectory().trajectory_poses.size() - 1;
+    const graph_utils::Transforms long_transforms = replicateOdometry(transforms, nb_measurements, replication_factor);
+
+    if (robot1_local_map.getNbDegreeFreedom() == 3) {
+        reportRelativePoses<graph_utils::PoseSE2>(argv[1], transforms);
+        reportRelativePoses<graph_utils::PoseSE2>("odometry repeated " + std::to_string(replication_factor) + " times", long_transforms);
+    } else {
+        reportRelativePoses<graph_utils::PoseSE3>(argv[1], transforms);
+        reportRelativePoses<graph_utils::PoseSE3>("odometry repeated " + std::to_string(replication_factor) + " times", long_transforms);
+    }
+    std::cout << argv[3] << " :" << std::endl;
+    reportConsistency(robot1_local_map, robot2_local_map, interrobot_measurements);
+
+    return 0;
+}
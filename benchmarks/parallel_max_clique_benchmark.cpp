@@ -0,0 +1,125 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file parallel_max_clique_benchmark.cpp
+ *  \brief Strong scaling of the parallel exact maximum clique search.
+ */
+
+#include "graph_utils/graph_utils_functions.h"
+#include "pairwise_consistency/pairwise_consistency.h"
+#include "max_clique_solver/fmc_graph.h"
+#include "max_clique_solver/parallel_max_clique.h"
+#include "robot_local_map/robot_local_map.h"
+#include "findClique.h"
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <algorithm>
+
+namespace {
+
+/** Random graph of edge probability density, with a clique planted on its first planted_clique_size vertices, then shuffled */
+void generateGraph(const size_t& nb_vertices, const double& density, const size_t& planted_clique_size, FMC::CGraphIO& gio) {
+    std::mt19937 generator(42);
+    std::bernoulli_distribution is_edge(density);
+    std::vector<int> permutation(nb_vertices);
+    for (size_t vertex = 0; vertex < nb_vertices; vertex++) {
+        permutation[vertex] = vertex;
+    }
+    std::shuffle(permutation.begin(), permutation.end(), generator);
+    std::vector<std::vector<int>> neighbors(nb_vertices);
+    for (size_t u = 0; u < nb_vertices; u++) {
+        for (size_t v = u + 1; v < nb_vertices; v++) {
+            if (v < planted_clique_size || is_edge(generator)) {
+                neighbors[permutation[u]].push_back(permutation[v]);
+                neighbors[permutation[v]].push_back(permutation[u]);
+            }
+        }
+    }
+    std::vector<int> vertices(1, 0), edges;
+    for (auto& vertex_neighbors: neighbors) {
+        std::sort(vertex_neighbors.begin(), vertex_neighbors.end());
+        edges.insert(edges.end(), vertex_neighbors.begin(), vertex_neighbors.end());
+        vertices.push_back(edges.size());
+    }
+    gio.SetAdjacencyGraph(vertices, edges);
+}
+
+/** Maximum clique with FMC::maxClique, then with the parallel search on 1 up to nb_threads threads */
+void reportScaling(const std::string& name, FMC::CGraphIO& gio, const size_t& nb_threads, const int& nb_runs) {
+    std::vector<int> serial_clique;
+    int serial_size = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        serial_clique.clear();
+        serial_size = FMC::maxClique(gio, 0, serial_clique);
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    const double serial_milliseconds = std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+    std::sort(serial_clique.begin(), serial_clique.end());
+
+    std::cout << name << " : " << gio.GetVertexCount() << " vertices, " << gio.GetEdgeCount() << " edges, density "
+              << 2.0 * gio.GetEdgeCount() / std::max(1.0, double(gio.GetVertexCount()) * (gio.GetVertexCount() - 1)) << std::endl;
+    std::cout << "  FMC::maxClique : " << serial_milliseconds << " ms, maximum clique " << serial_size << std::endl;
+    double one_thread_milliseconds = 0;
+    for (size_t threads = 1; threads <= nb_threads; threads *= 2) {
+        max_clique_solver::ParallelMaxClique search(gio, threads);
+        std::vector<int> max_clique;
+        int max_clique_size = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (int run = 0; run < nb_runs; run++) {
+            max_clique_size = search.findMaxClique(0, max_clique);
+        }
+        finish = std::chrono::high_resolution_clock::now();
+        const double milliseconds = std::chrono::duration<double, std::milli>(finish - start).count() / nb_runs;
+        if (threads == 1) {
+            one_thread_milliseconds = milliseconds;
+        }
+        std::cout << "  parallel, " << threads << " thread(s) : " << milliseconds << " ms (x" << serial_milliseconds / milliseconds
+                  << " FMC, x" << one_thread_milliseconds / milliseconds << " 1 thread), " << search.getNbExpandedNodes() << " nodes, "
+                  << search.getNbStolenTasks() << " stolen tasks, " << search.getNbSplitTasks() << " split tasks"
+                  << (max_clique_size == serial_size && max_clique == serial_clique ? ", same clique" : ", DIFFERENT") << std::endl;
+    }
+}
+
+}
+
+/** \brief Benchmark of the parallel exact maximum clique search.
+ *
+ * Arguments : <trajectory robot1 file> <trajectory robot2 file> <inter robot loop closures file> [maximum number of threads] [number of runs (default 1)]
+ * Compares FMC::maxClique with the parallel search on 1 up to the maximum number of threads, on the consistency
+ * graph of the loop closures and on synthetic dense graphs : a random one, and one with a large planted clique
+ * as the consistency graphs of loop closures with many inliers. Checks that the cliques are the same.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "Please specify 3 input files, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL_robot1.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_robot2.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures_outliers.g2o" << std::endl;
+        return -1;
+    }
+    const size_t nb_threads = argc > 4 ? std::stoul(argv[4]) : std::max<size_t>(1, std::thread::hardware_concurrency());
+    const int nb_runs = argc > 5 ? std::stoi(argv[5]) : 1;
+
+    auto robot1_local_map = robot_local_map::RobotLocalMap(argv[1]);
+    auto robot2_local_map = robot_local_map::RobotLocalMap(argv[2]);
+    auto interrobot_measurements = robot_local_map::RobotMeasurements(argv[3], true);
+    pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+        interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+        robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom());
+    FMC::CGraphIO consistency_gio;
+    max_clique_solver::loadConsistencyGraph(pairwise_consistency.computeConsistencyGraph(), consistency_gio);
+    reportScaling(argv[3], consistency_gio, nb_threads, nb_runs);
+
+    FMC::CGraphIO random_gio;
+    generateGraph(300, 0.5, 0, random_gio);
+    reportScaling("random graph", random_gio, nb_threads, nb_runs);
+
+    FMC::CGraphIO planted_gio;
+    generateGraph(1000, 0.3, 100, planted_gio);
+    reportScaling("random graph with a planted clique", planted_gio, nb_threads, nb_runs);
+
+    return 0;
+}
@@ -0,0 +1,185 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file pose_algebra_benchmark.cpp
+ *  \brief Throughput and agreement of the native pose algebra with MRPT.
+ */
+
+#include "graph_utils/pose_algebra.h"
+#include <mrpt/poses/CPose3DPDFGaussian.h>
+#include <mrpt_bridge/pose.h>
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace mrpt::poses;
+
+namespace {
+
+typedef Eigen::Matrix<double, 6, 6> Matrix6d;
+
+/** Random pose with a random positive definite covariance, planar poses only have x, y and yaw */
+geometry_msgs::PoseWithCovariance randomPose(std::mt19937& generator, const bool& is_planar) {
+    std::uniform_real_distribution<double> position(-10, 10), angle(-M_PI, M_PI), pitch(-1.4, 1.4);
+    std::normal_distribution<double> noise(0, 0.1);
+    graph_utils::PoseSE3 pose;
+    pose.translation << position(generator), position(generator), is_planar ? 0 : position(generator);
+    pose.yaw = angle(generator);
+    pose.pitch = is_planar ? 0 : pitch(generator);
+    pose.roll = is_planar ? 0 : angle(generator);
+    const int dimension = is_planar ? 3 : 6;
+    Eigen::MatrixXd factor(dimension, dimension);
+    for (int k = 0; k < factor.size(); k++) {
+        factor(k) = noise(generator);
+    }
+    const Eigen::MatrixXd covariance = factor * factor.transpose() + 1e-3 * Eigen::MatrixXd::Identity(dimension, dimension);
+    pose.covariance.setZero();
+    if (is_planar) {
+        // (x, y, yaw) block of the (x, y, z, yaw, pitch, roll) covariance
+        const int indexes[3] = {0, 1, 3};
+        for (int row = 0; row < 3; row++) {
+            for (int col = 0; col < 3; col++) {
+                pose.covariance(indexes[row], indexes[col]) = covariance(row, col);
+            }
+        }
+    } else {
+        pose.covariance = covariance;
+    }
+    geometry_msgs::PoseWithCovariance result;
+    graph_utils::toPoseWithCovariance(pose, result);
+    return result;
+}
+
+/** Reference implementations, identical to the MRPT path of graph_utils */
+void composeMRPT(const geometry_msgs::PoseWithCovariance& a, const geometry_msgs::PoseWithCovariance& b, geometry_msgs::PoseWithCovariance& out) {
+    CPose3DPDFGaussian A(UNINITIALIZED_POSE), B(UNINITIALIZED_POSE);
+    mrpt_bridge::convert(a, A);
+    mrpt_bridge::convert(b, B);
+    const CPose3DPDFGaussian OUT = A + B;
+    mrpt_bridge::convert(OUT, out);
+}
+
+void inverseComposeMRPT(const geometry_msgs::PoseWithCovariance& a, const geometry_msgs::PoseWithCovariance& b, geometry_msgs::PoseWithCovariance& out) {
+    CPose3DPDFGaussian A(UNINITIALIZED_POSE), B(UNINITIALIZED_POSE);
+    mrpt_bridge::convert(a, A);
+    mrpt_bridge::convert(b, B);
+    const CPose3DPDFGaussian OUT = A - B;
+    mrpt_bridge::convert(OUT, out);
+}
+
+void inverseMRPT(const geometry_msgs::PoseWithCovariance& a, const geometry_msgs::PoseWithCovariance&, geometry_msgs::PoseWithCovariance& out) {
+    CPose3DPDFGaussian A(UNINITIALIZED_POSE), OUT;
+    mrpt_bridge::convert(a, A);
+    A.inverse(OUT);
+    mrpt_bridge::convert(OUT, out);
+}
+
+/** Native implementations, through the same geometry_msgs conversions as graph_utils */
+template <typename Pose, void (*Operation)(const Pose&, const Pose&, Pose&)>
+void binaryNative(const geometry_msgs::PoseWithCovariance& a, const geometry_msgs::PoseWithCovariance& b, geometry_msgs::PoseWithCovariance& out) {
+    Pose A, B, OUT;
+    graph_utils::fromPoseWithCovariance(a, A);
+    graph_utils::fromPoseWithCovariance(b, B);
+    Operation(A, B, OUT);
+    graph_utils::toPoseWithCovariance(OUT, out);
+}
+
+template <typename Pose, void (*Operation)(const Pose&, Pose&)>
+void unaryNative(const geometry_msgs::PoseWithCovariance& a, const geometry_msgs::PoseWithCovariance&, geometry_msgs::PoseWithCovariance& out) {
+    Pose A, OUT;
+    graph_utils::fromPoseWithCovariance(a, A);
+    Operation(A, OUT);
+    graph_utils::toPoseWithCovariance(OUT, out);
+}
+
+typedef void (*Operation)(const geometry_msgs::PoseWithCovariance&, const geometry_msgs::PoseWithCovariance&, geometry_msgs::PoseWithCovariance&);
+
+/** Runs an operation on all the pairs of consecutive poses, returns the number of operations per second */
+double opsPerSecond(const std::vector<geometry_msgs::PoseWithCovariance>& poses, const int& nb_runs,
+                    Operation operation, std::vector<geometry_msgs::PoseWithCovariance>& results) {
+    results.resize(poses.size() - 1);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int run = 0; run < nb_runs; run++) {
+        for (size_t p = 0; p + 1 < poses.size(); p++) {
+            operation(poses[p], poses[p + 1], results[p]);
+        }
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    return nb_runs * results.size() / std::chrono::duration<double>(finish - start).count();
+}
+
+/** Largest differences of the poses, and of the covariances relative to their largest entry */
+void maxDifferences(const std::vector<geometry_msgs::PoseWithCovariance>& reference, const std::vector<geometry_msgs::PoseWithCovariance>& results,
+                    double& pose_difference, double& covariance_difference) {
+    pose_difference = 0;
+    covariance_difference = 0;
+    for (size_t p = 0; p < reference.size(); p++) {
+        const geometry_msgs::Pose& a = reference[p].pose;
+        const geometry_msgs::Pose& b = results[p].pose;
+        const double differences[7] = {a.position.x - b.position.x, a.position.y - b.position.y, a.position.z - b.position.z,
+            a.orientation.x - b.orientation.x, a.orientation.y - b.orientation.y, a.orientation.z - b.orientation.z, a.orientation.w - b.orientation.w};
+        for (const double& difference: differences) {
+            pose_difference = std::max(pose_difference, std::abs(difference));
+        }
+        double scale = 0, difference = 0;
+        for (int k = 0; k < 36; k++) {
+            scale = std::max(scale, std::abs(reference[p].covariance[k]));
+            difference = std::max(difference, std::abs(reference[p].covariance[k] - results[p].covariance[k]));
+        }
+        covariance_difference = std::max(covariance_difference, difference / scale);
+    }
+}
+
+void compare(const std::string& name, const std::vector<geometry_msgs::PoseWithCovariance>& poses, const int& nb_runs,
+             Operation reference, Operation native) {
+    std::vector<geometry_msgs::PoseWithCovariance> reference_results, native_results;
+    const double reference_ops = opsPerSecond(poses, nb_runs, reference, reference_results);
+    const double native_ops = opsPerSecond(poses, nb_runs, native, native_results);
+    double pose_difference, covariance_difference;
+    maxDifferences(reference_results, native_results, pose_difference, covariance_difference);
+    std::cout << "  " << name << " : MRPT " << reference_ops << " ops/s, native " << native_ops << " ops/s (x"
+              << native_ops / reference_ops << "), max difference pose " << pose_difference
+              << ", covariance (relative) " << covariance_difference << std::endl;
+}
+
+}
+
+/** \brief Benchmark of the pose compositions with covariance.
+ *
+ * Arguments : [number of poses (default 10000)] [number of runs (default 10)]
+ * Runs poseCompose, poseInverseCompose and poseInverse with MRPT and with the closed-form Jacobians
+ * of graph_utils/pose_algebra.h, on random 3D poses (SE3) and planar poses (SE3 and SE2), and reports
+ * the operations per second and the largest differences with MRPT.
+ */
+int main(int argc, char* argv[])
+{
+    const size_t nb_poses = argc > 1 ? std::stoul(argv[1]) : 10000;
+    const int nb_runs = argc > 2 ? std::stoi(argv[2]) : 10;
+    if (nb_poses < 2) {
+        std::cout << "Please specify at least 2 poses." << std::endl;
+        return -1;
+    }
+
+    std::mt19937 generator(42);
+    std::vector<geometry_msgs::PoseWithCovariance> poses_3d, poses_2d;
+    for (size_t p = 0; p < nb_poses; p++) {
+        poses_3d.push_back(randomPose(generator, false));
+        poses_2d.push_back(randomPose(generator, true));
+    }
+
+    std::cout << "3D poses, SE3" << std::endl;
+    compare("compose        ", poses_3d, nb_runs, composeMRPT, binaryNative<graph_utils::PoseSE3, graph_utils::composeSE3>);
+    compare("inverse compose", poses_3d, nb_runs, inverseComposeMRPT, binaryNative<graph_utils::PoseSE3, graph_utils::inverseComposeSE3>);
+    compare("inverse        ", poses_3d, nb_runs, inverseMRPT, unaryNative<graph_utils::PoseSE3, graph_utils::inverseSE3>);
+    std::cout << "2D poses, SE3" << std::endl;
+    compare("compose        ", poses_2d, nb_runs, composeMRPT, binaryNative<graph_utils::PoseSE3, graph_utils::composeSE3>);
+    compare("inverse compose", poses_2d, nb_runs, inverseComposeMRPT, binaryNative<graph_utils::PoseSE3, graph_utils::inverseComposeSE3>);
+    compare("inverse        ", poses_2d, nb_runs, inverseMRPT, unaryNative<graph_utils::PoseSE3, graph_utils::inverseSE3>);
+    std::cout << "2D poses, SE2" << std::endl;
+    compare("compose        ", poses_2d, nb_runs, composeMRPT, binaryNative<graph_utils::PoseSE2, graph_utils::composeSE2>);
+    compare("inverse compose", poses_2d, nb_runs, inverseComposeMRPT, binaryNative<graph_utils::PoseSE2, graph_utils::inverseComposeSE2>);
+    compare("inverse        ", poses_2d, nb_runs, inverseMRPT, unaryNative<graph_utils::PoseSE2, graph_utils::inverseSE2>);
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file relative_pose_cache_benchmark.cpp
+ *  \brief Hit rate and per-pair cost of the cache of the relative poses on the trajectories.
+ */
+
+#include "graph_utils/pose_algebra.h"
+#include "graph_utils/relative_pose_cache.h"
+#include "pairwise_consistency/pairwise_consistency.h"
+#include "robot_local_map/robot_local_map.h"
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <algorithm>
+
+namespace {
+
+/** Number of synthetic loop closures of the dataset with many revisits */
+const size_t NB_REVISIT_LOOP_CLOSURES = 1000;
+
+/** Number of places revisited on each trajectory, and number of consecutive poses of a place */
+const size_t NB_PLACES = 20, PLACE_SIZE = 5;
+
+/** Trajectory indexes of the poses i (robot A) and k (robot B) of a loop closure */
+typedef std::vector<std::pair<size_t, size_t>> LoopClosureIndexes;
+
+/** Indexes of the real loop closures from robot 1 to robot 2 */
+LoopClosureIndexes getRealLoopClosures(const std::vector<pairwise_consistency::LoopClosureEntry>& entries) {
+    LoopClosureIndexes result;
+    for (const auto& entry: entries) {
+        if (entry.orientations & pairwise_consistency::LoopClosureEntry::ROBOT1_TO_ROBOT2) {
+            result.emplace_back(entry.first_indexes[0], entry.second_indexes[1]);
+        }
+    }
+    return result;
+}
+
+/** Loop closures clustered on a few places of each trajectory, as with repeated detections of the same places */
+LoopClosureIndexes generateRevisits(const size_t& trajectory_size1, const size_t& trajectory_size2) {
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<size_t> places1(0, trajectory_size1 - PLACE_SIZE), places2(0, trajectory_size2 - PLACE_SIZE);
+    std::vector<size_t> starts1(NB_PLACES), starts2(NB_PLACES);
+    for (size_t place = 0; place < NB_PLACES; place++) {
+        starts1[place] = places1(generator);
+        starts2[place] = places2(generator);
+    }
+    std::uniform_int_distribution<size_t> place(0, NB_PLACES - 1), offset(0, PLACE_SIZE - 1);
+    LoopClosureIndexes result(NB_REVISIT_LOOP_CLOSURES);
+    for (auto& loop_closure: result) {
+        loop_closure.first = starts1[place(generator)] + offset(generator);
+        loop_closure.second = starts2[place(generator)] + offset(generator);
+    }
+    return result;
+}
+
+/**
+ * Relative poses aXij and bXlk of all the pairs of loop closures, computed by the threads on interleaved rows.
+ * The checksum of the means does not depend on the number of threads.
+ */
+template <typename Pose, typename RelativePose>
+double computeRelativePoses(const LoopClosureIndexes& loop_closures, const size_t& nb_threads,
+                            RelativePose relative_pose, double& checksum) {
+    std::vector<double> checksums(nb_threads, 0);
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t thread = 0; thread < nb_threads; thread++) {
+        threads.emplace_back([&, thread]() {
+            Pose aXij, bXlk;
+            for (size_t u = thread; u < loop_closures.size(); u += nb_threads) {
+                for (size_t v = u + 1; v < loop_closures.size(); v++) {
+                    relative_pose(0, loop_closures[u].first, loop_closures[v].first, aXij);
+                    relative_pose(1, loop_closures[v].second, loop_closures[u].second, bXlk);
+                    checksums[thread] += aXij.covariance(0, 0) + bXlk.covariance(0, 0);
+                }
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    checksum = 0;
+    for (const double& thread_checksum: checksums) {
+        checksum += thread_checksum;
+    }
+    const size_t nb_pairs = loop_closures.size() * (loop_closures.size() - std::min<size_t>(1, loop_closures.size())) / 2;
+    return std::chrono::duration<double, std::nano>(finish - start).count() / std::max<size_t>(1, nb_pairs);
+}
+
+/** Per-pair cost of the relative poses composed from the odometry trees, with and without the cache */
+template <typename Pose>
+void reportCache(const std::string& name, const pairwise_consistency::ConsistencyPoses<Pose>& poses,
+                 const size_t& start_id1, const size_t& start_id2, const LoopClosureIndexes& loop_closures, const size_t& nb_threads) {
+    // Xid1^-1 + Xid2 from the odometry between the poses, as the consistency test queries it
+    auto compute = [&poses](const int& robot, const size_t& index1, const size_t& index2, Pose& result) {
+        poses.odometries[robot].getRelativePose(index1, index2, result);
+    };
+    const size_t start_ids[2] = {start_id1, start_id2};
+    graph_utils::RelativePoseCache<Pose> cache;
+    auto cached = [&](const int& robot, const size_t& index1, const size_t& index2, Pose& result) {
+        cache.get(robot, start_ids[robot] + index1, start_ids[robot] + index2, [&](Pose& pose) {
+            compute(robot, index1, index2, pose);
+        }, result);
+    };
+
+    std::cout << name << " : " << loop_closures.size() << " loop closures, "
+              << loop_closures.size() * (loop_closures.size() - std::min<size_t>(1, loop_closures.size())) / 2 << " pairs" << std::endl;
+    double reference_checksum, checksum;
+    const double uncached_nanoseconds = computeRelativePoses<Pose>(loop_closures, 1, compute, reference_checksum);
+    std::cout << "  without cache : " << uncached_nanoseconds << " ns/pair" << std::endl;
+    for (size_t threads = 1; threads <= nb_threads; threads *= 2) {
+        cache.clear();
+        const double cached_nanoseconds = computeRelativePoses<Pose>(loop_closures, threads, cached, checksum);
+        std::cout << "  with cache, " << threads << " thread(s) : " << cached_nanoseconds << " ns/pair (x"
+                  << uncached_nanoseconds / cached_nanoseconds << "), " << cache.getNbHits() << " hits, " << cache.getNbMisses()
+                  << " misses (" << 100.0 * cache.getNbHits() / std::max<size_t>(1, cache.getNbHits() + cache.getNbMisses())
+                  << "% hits), " << cache.size() << " relative poses"
+                  << (std::abs(checksum - reference_checksum) <= 1e-9 * std::abs(reference_checksum) ? ", identical" : ", DIFFERENT")
+                  << std::endl;
+    }
+}
+
+}
+
+/** \brief Benchmark of the cache of the relative poses between two poses of a trajectory.
+ *
+ * Arguments : <trajectory robot1 file> <trajectory robot2 file> <inter robot loop closures file> [maximum number of threads]
+ * Computes aXij and bXlk from the odometry trees, as the consistency test does with use_odometry_relative_poses,
+ * for all the pairs of the real loop closures and of loop closures clustered on a few places (many revisits),
+ * without the cache and with the cache on 1 up to the maximum number of threads.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "Please specify 3 input files, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL_robot1.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_robot2.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures_outliers.g2o" << std::endl;
+        return -1;
+    }
+    const size_t nb_threads = argc > 4 ? std::stoul(argv[4]) : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    auto robot1_local_map = robot_local_map::RobotLocalMap(argv[1]);
+    auto robot2_local_map = robot_local_map::RobotLocalMap(argv[2]);
+    auto interrobot_measurements = robot_local_map::RobotMeasurements(argv[3], true);
+    pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+        interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+        robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom(), 1, true, true);
+    const size_t start_id1 = robot1_local_map.getTrajectory().start_id, start_id2 = robot2_local_map.getTrajectory().start_id;
+    const size_t trajectory_size1 = robot1_local_map.getTrajectory().trajectory_poses.size();
+    const size_t trajectory_size2 = robot2_local_map.getTrajectory().trajectory_poses.size();
+
+    if (robot1_local_map.getNbDegreeFreedom() == 3) {
+        const auto& poses = pairwise_consistency.getLoopClosureTable<graph_utils::PoseSE2>();
+        reportCache(argv[3], poses, start_id1, start_id2, getRealLoopClosures(poses.loop_closure_entries), nb_threads);
+        reportCache("revisits", poses, start_id1, start_id2, generateRevisits(trajectory_size1, trajectory_size2), nb_threads);
+    } else {
+        const auto& poses = pairwise_consistency.getLoopClosureTable<graph_utils::PoseSE3>();
+        reportCache(argv[3], poses, start_id1, start_id2, getRealLoopClosures(poses.loop_closure_entries), nb_threads);
+        reportCache("revisits", poses, start_id1, start_id2, generateRevisits(trajectory_size1, trajectory_size2), nb_threads);
+    }
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file warm_start_benchmark.cpp
+ *  \brief Nodes expanded by the exact maximum clique searches with and without the heuristic clique as lower bound.
+ */
+
+#include "graph_utils/graph_utils_functions.h"
+#include "pairwise_consistency/pairwise_consistency.h"
+#include "max_clique_solver/fmc_graph.h"
+#include "max_clique_solver/parallel_max_clique.h"
+#include "max_clique_solver/bitset_max_clique.h"
+#include "robot_local_map/robot_local_map.h"
+#include "findClique.h"
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <algorithm>
+
+namespace {
+
+/** Exact search : size of the maximum clique for a lower bound, and number of nodes expanded */
+typedef std::function<int(FMC::CGraphIO&, const int&, size_t&)> ExactSearch;
+
+/** Random graph of edge probability density, with a clique planted on planted_clique_size random vertices */
+void generateGraph(const size_t& nb_vertices, const double& density, const size_t& planted_clique_size, FMC::CGraphIO& gio) {
+    std::mt19937 generator(42);
+    std::bernoulli_distribution is_edge(density);
+    std::vector<int> permutation(nb_vertices);
+    for (size_t vertex = 0; vertex < nb_vertices; vertex++) {
+        permutation[vertex] = vertex;
+    }
+    std::shuffle(permutation.begin(), permutation.end(), generator);
+    std::vector<std::vector<int>> neighbors(nb_vertices);
+    for (size_t u = 0; u < nb_vertices; u++) {
+        for (size_t v = u + 1; v < nb_vertices; v++) {
+            if (v < planted_clique_size || is_edge(generator)) {
+                neighbors[permutation[u]].push_back(permutation[v]);
+                neighbors[permutation[v]].push_back(permutation[u]);
+            }
+        }
+    }
+    std::vector<int> vertices(1, 0), edges;
+    for (auto& vertex_neighbors: neighbors) {
+        std::sort(vertex_neighbors.begin(), vertex_neighbors.end());
+        edges.insert(edges.end(), vertex_neighbors.begin(), vertex_neighbors.end());
+        vertices.push_back(edges.size());
+    }
+    gio.SetAdjacencyGraph(vertices, edges);
+}
+
+/** Heuristic clique, then each exact search without lower bound and with the size of the heuristic clique */
+void reportWarmStart(const std::string& name, FMC::CGraphIO& gio, const std::vector<std::pair<std::string, ExactSearch>>& searches) {
+    std::vector<int> heuristic_clique;
+    auto start = std::chrono::high_resolution_clock::now();
+    const int heuristic_size = std::max(0, FMC::maxCliqueHeu(gio, heuristic_clique));
+    auto finish = std::chrono::high_resolution_clock::now();
+    std::cout << name << " : " << gio.GetVertexCount() << " vertices, " << gio.GetEdgeCount() << " edges" << std::endl;
+    std::cout << "  heuristic : clique of " << heuristic_size << " vertices in "
+              << std::chrono::duration<double, std::milli>(finish - start).count() << " ms" << std::endl;
+
+    for (const auto& search: searches) {
+        size_t cold_nb_nodes, warm_nb_nodes;
+        start = std::chrono::high_resolution_clock::now();
+        const int cold_size = search.second(gio, 0, cold_nb_nodes);
+        auto middle = std::chrono::high_resolution_clock::now();
+        const int warm_size = search.second(gio, heuristic_size, warm_nb_nodes);
+        finish = std::chrono::high_resolution_clock::now();
+        std::cout << "  " << search.first << " : " << cold_nb_nodes << " nodes, "
+                  << std::chrono::duration<double, std::milli>(middle - start).count() << " ms without warm start | "
+                  << warm_nb_nodes << " nodes, " << std::chrono::duration<double, std::milli>(finish - middle).count()
+                  << " ms with warm start, maximum clique " << cold_size
+                  << (warm_size == cold_size ? "" : ", DIFFERENT") << (cold_size == heuristic_size ? " (heuristic optimal)" : "") << std::endl;
+    }
+}
+
+}
+
+/** \brief Benchmark of the heuristic clique as lower bound of the exact maximum clique searches.
+ *
+ * Arguments : <trajectory robot1 file> <trajectory robot2 file> <inter robot loop closures file>...
+ * For the consistency graph of each file of inter robot loop closures and for synthetic dense graphs, counts the
+ * nodes expanded by FMC::maxClique, the parallel search on one thread and the bitset search, with a lower bound
+ * of 0 and with the size of the clique of FMC::maxCliqueHeu.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 4) {
+        std::cout << "Please specify at least 3 input files, e.g. pose_graph_datasets/CSAIL_dataset/CSAIL_robot1.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_robot2.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures.g2o "
+                     "pose_graph_datasets/CSAIL_dataset/CSAIL_interrobot_loop_closures_outliers.g2o" << std::endl;
+        return -1;
+    }
+
+    const std::vector<std::pair<std::string, ExactSearch>> searches = {
+        {"FMC::maxClique", [](FMC::CGraphIO& gio, const int& lower_bound, size_t& nb_nodes) {
+            std::vector<int> max_clique;
+            const int size = FMC::maxClique(gio, lower_bound, max_clique);
+            nb_nodes = FMC::expandedNodes;
+            return size;
+        }},
+        {"parallel search, 1 thread", [](FMC::CGraphIO& gio, const int& lower_bound, size_t& nb_nodes) {
+            max_clique_solver::ParallelMaxClique search(gio, 1);
+            std::vector<int> max_clique;
+            const int size = search.findMaxClique(lower_bound, max_clique);
+            nb_nodes = search.getNbExpandedNodes();
+            return size;
+        }},
+        {"bitset search", [](FMC::CGraphIO& gio, const int& lower_bound, size_t& nb_nodes) {
+            max_clique_solver::BitsetMaxClique search(gio);
+            std::vector<int> max_clique;
+            const int size = search.findMaxClique(lower_bound, max_clique);
+            nb_nodes = search.getNbExpandedNodes();
+            return size;
+        }}
+    };
+
+    auto robot1_local_map = robot_local_map::RobotLocalMap(argv[1]);
+    auto robot2_local_map = robot_local_map::RobotLocalMap(argv[2]);
+    for (int arg = 3; arg < argc; arg++) {
+        auto interrobot_measurements = robot_local_map::RobotMeasurements(argv[arg], true);
+        pairwise_consistency::PairwiseConsistency pairwise_consistency(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(),
+            interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
+            robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(), robot1_local_map.getNbDegreeFreedom());
+        FMC::CGraphIO gio;
+        max_clique_solver::loadConsistencyGraph(pairwise_consistency.computeConsistencyGraph(), gio);
+        reportWarmStart(argv[arg], gio, searches);
+    }
+
+    FMC::CGraphIO random_gio;
+    generateGraph(200, 0.5, 0, random_gio);
+    reportWarmStart("random graph", random_gio, searches);
+
+    FMC::CGraphIO planted_gio;
+    generateGraph(1000, 0.3, 100, planted_gio);
+    reportWarmStart("random graph with a planted clique", planted_gio, searches);
+
+    return 0;
+}
@@ -13,11 +13,13 @@
 #include <iostream>
 #include <eigen3/Eigen/Geometry>
 #include <chrono>
+#include <vector>
 
 /** \brief Main function of an example program using this package.
  * 
  * In this example, we use 3 input files  <trajectory robot1 .g2o file> <trajectory robot2 .g2o file> <inter robot loop closures .g2o file>
- * to produce a resulting global pose graph.
+ * to produce a resulting global pose graph. Thresholds on the squared Mahalanobis distance can follow the
+ * 3 files, in which case the maximum clique size is also reported for each of them.
  */ 
 int main(int argc, char* argv[])
 {
@@ -59,5 +61,22 @@ int main(int argc, char* argv[])
   std::cout << " | Completed (" << milliseconds.count() << "ms)" << std::endl;
   std::cout << "Maximum clique size = " << max_clique_size << std::endl;
 
+  //--- Threshold sweep
+  std::vector<double> thresholds;
+  for (int arg = 4; arg < argc; arg++) {
+    thresholds.push_back(std::stod(argv[arg]));
+  }
+  if (!thresholds.empty()) {
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<int> max_clique_sizes = solver.computeMaxCliqueSizes(thresholds);
+    finish = std::chrono::high_resolution_clock::now();
+    milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(finish-start);
+    for (size_t index = 0; index < thresholds.size(); index++) {
+      std::cout << "Threshold " << thresholds[index] << " : maximum clique size = " << max_clique_sizes[index] << std::endl;
+    }
+    std::cout << "Threshold sweep completed (" << milliseconds.count() << "ms)" << std::endl;
+  }
+  //---
+
   return 0;
 }
\ No newline at end of file
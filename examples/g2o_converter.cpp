@@ -0,0 +1,52 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+/** \file g2o_converter.cpp
+ *  \brief Conversion of .g2o files to binary pose graph files.
+ */
+
+#include "graph_utils/graph_utils_functions.h"
+#include "graph_utils/g2o_parser.h"
+#include "graph_utils/pose_graph_binary.h"
+#include <string>
+#include <iostream>
+#include <chrono>
+
+/** \brief Converts a .g2o file to a binary pose graph file (.pgb).
+ *
+ * Arguments : <input .g2o file> <output .pgb file> [only loop closures (0 or 1)]
+ * Local maps are saved with their precomputed trajectory, so loading them does not recompose the odometry.
+ */
+int main(int argc, char* argv[])
+{
+  if (argc < 3) {
+    std::cout << "Please specify an input .g2o file and an output " << graph_utils::POSE_GRAPH_BINARY_EXTENSION << " file." << std::endl;
+    return -1;
+  }
+  const std::string input_file_name = argv[1];
+  const std::string output_file_name = argv[2];
+  const bool only_loop_closures = argc > 3 && std::stoi(argv[3]) != 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  size_t num_poses;
+  graph_utils::Transforms transforms;
+  graph_utils::LoopClosures loop_closures;
+  uint8_t nb_degree_freedom = graph_utils::parseG2ofileMapped(input_file_name, num_poses, transforms, loop_closures, only_loop_closures);
+
+  graph_utils::Trajectory trajectory;
+  if (!only_loop_closures) {
+    trajectory = graph_utils::buildTrajectory(transforms);
+  }
+
+  if (!graph_utils::writePoseGraphBinary(output_file_name, num_poses, transforms, loop_closures, nb_degree_freedom, trajectory)) {
+    std::cerr << "Error while writing the file " << output_file_name << std::endl;
+    return -1;
+  }
+
+  auto finish = std::chrono::high_resolution_clock::now();
+  auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(finish-start);
+  std::cout << "Converted " << transforms.transforms.size() << " transforms, " << trajectory.trajectory_poses.size()
+            << " trajectory poses and " << loop_closures.size() << " loop closures (" << milliseconds.count() << "ms)" << std::endl;
+
+  return 0;
+}
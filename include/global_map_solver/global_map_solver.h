@@ -8,15 +8,39 @@
 #include "SESync/SESync.h"
 #include "SESync/SESync_utils.h"
 #include <string>
+#include <vector>
 
 namespace global_map_solver {
+    /** \struct GlobalMapSolverOptions
+     * \brief Options of the consistency evaluation and of the maximum clique search of GlobalMapSolver
+     *
+     * The defaults compute the sparse consistency graph with the early rejection, and search its maximum
+     * clique with the Fast Max-Cliquer on a single thread.
+     *
+     * With use_lazy_consistency, the consistency graph is not computed beforehand : the maximum clique search
+     * evaluates the pairs of loop closures of its candidate sets on demand, one at a time on the calling thread,
+     * and starts without the heuristic clique (it would need the whole graph). solveGlobalMap then ignores
+     * nb_threads, use_packed_consistency_matrix, export_consistency_matrix and use_bitset_max_clique, and the
+     * constructor prints a warning if one of them is set. computeMaxCliqueSizes always computes the consistency
+     * graphs and uses them.
+     */
+    struct GlobalMapSolverOptions {
+        size_t nb_threads = 1;///< Threads computing the consistency matrix and searching its maximum clique (0 for all the hardware threads).
+        bool use_packed_consistency_matrix = false;///< Compute the consistency graph as a matrix packed in bits instead of a sparse adjacency, smaller when most of the loop closures are consistent.
+        bool use_lazy_consistency = false;///< Evaluate the pairs of loop closures on demand during the maximum clique search (see above).
+        bool export_consistency_matrix = false;///< Also write the consistency graph to GlobalMapSolver::CONSISTENCY_MATRIX_FILE_NAME, for debugging. The results/ directory must exist.
+        bool use_bitset_max_clique = false;///< Search the maximum clique on bitsets with coloring bounds (single-threaded), which prunes more on dense graphs. Another clique of the same size may be found.
+        bool use_early_rejection = true;///< Reject the pairs whose loop, composed without the covariances, is provably inconsistent before propagating the covariances.
+        bool use_odometry_relative_poses = false;///< Compose the relative poses of a pair from the odometry between the poses, so that their common history is not counted twice. More pairs can then be consistent.
+    };
+
     /** \class GlobalMapSolver
      * \brief Class computing the global map from multiple robots local maps.
      */ 
     class GlobalMapSolver {
       public:
         /** \var CONSISTENCY_MATRIX_FILE_NAME
-         * \brief File name in which the consistency matrix will be saved
+         * \brief File name in which the consistency matrix is exported, if requested
          */
         static const std::string CONSISTENCY_MATRIX_FILE_NAME;
 
@@ -31,10 +55,12 @@ namespace global_map_solver {
          * @param robot1_local_map Local map of robot 1.
          * @param robot2_local_map Local map of robot 2.
          * @param interrobot_measurements Inter-robot measurements.
+         * @param options Options of the consistency evaluation and of the maximum clique search.
          */
         GlobalMapSolver(const robot_local_map::RobotLocalMap& robot1_local_map,
                         const robot_local_map::RobotLocalMap& robot2_local_map,
-                        const robot_local_map::RobotMeasurements& interrobot_measurements);
+                        const robot_local_map::RobotMeasurements& interrobot_measurements,
+                        const GlobalMapSolverOptions& options = GlobalMapSolverOptions());
 
         /**
          * \brief Function that solves the global maps according to the current constraints
@@ -43,13 +69,28 @@ namespace global_map_solver {
          */
         int solveGlobalMap();
 
+        /**
+         * \brief Sizes of the maximum cliques of the consistency graphs for several thresholds
+         *
+         * The pairs of loop closures are evaluated once, for the largest threshold, and the consistency
+         * graph of each threshold is derived from their squared Mahalanobis distances.
+         *
+         * @param thresholds Thresholds on the squared Mahalanobis distance
+         * @return the size of the maximum clique for each threshold.
+         */
+        std::vector<int> computeMaxCliqueSizes(const std::vector<double>& thresholds);
+
       private:
         pairwise_consistency::PairwiseConsistency pairwise_consistency_; ///< Pairwise consistency solver.
 
+        GlobalMapSolverOptions options_; ///< Options of the consistency evaluation and of the maximum clique search.
+
         /**
          * \brief This functions fill the structure measurements_t whitout the spurious measurements
          * in order to use SE-Sync.
          *
+         * The measurements of each transform store are in its insertion order (see graph_utils::TransformStore).
+         *
          * @param loop_closures List of loop closures
          * @param max_clique_data List of valid loop closures ID
          * @return the formatted measurements
@@ -0,0 +1,112 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_CONSISTENCY_DISTANCES_H
+#define GRAPH_UTILS_CONSISTENCY_DISTANCES_H
+
+#include "graph_utils/consistency_graph.h"
+#include "graph_utils/packed_consistency_matrix.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace graph_utils {
+
+/** \class ConsistencyDistances
+ *  \brief Squared Mahalanobis distances of the consistency loops of the pairs of loop closures, in sparse form.
+ *
+ *  Only the pairs closer than a maximum threshold are stored, with their distance in single precision.
+ *  The consistency graph for any threshold up to the maximum is derived in one pass over the pairs,
+ *  so that the threshold can be tuned without evaluating the pairs again.
+ */
+class ConsistencyDistances {
+  public:
+    /** \struct Entry
+     *  \brief Pair (u, v), u < v, of loop closures and the squared Mahalanobis distance of its consistency loop
+     */
+    struct Entry {
+        uint32_t u, v;
+        float distance;
+    };
+
+    /** \typedef Entries
+     *  \brief Buffer of pairs of loop closures
+     */
+    typedef std::vector<Entry> Entries;
+
+    /**
+     * \brief Constructor of an empty set of distances
+     */
+    ConsistencyDistances();
+
+    /**
+     * \brief Gathers buffers of pairs, e.g. one per thread
+     *
+     * The buffers are emptied and the pairs are sorted, so that the result does not depend on the
+     * distribution of the pairs between the buffers. A pair must appear only once in the buffers.
+     * @param nb_vertices Number of loop closures
+     * @param max_threshold Threshold below which the pairs are kept
+     * @param entry_buffers Buffers of pairs (u, v) with u < v < nb_vertices and a distance lower than max_threshold
+     */
+    ConsistencyDistances(const size_t& nb_vertices, const double& max_threshold, std::vector<Entries>& entry_buffers);
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of loop closures
+     */
+    size_t getNbVertices() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the threshold below which the pairs are kept, the largest threshold of the derived graphs
+     */
+    double getMaxThreshold() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the pairs with a distance lower than the maximum threshold, sorted by (u, v)
+     */
+    const Entries& getEntries() const;
+
+    /**
+     * \brief Consistency graph for a threshold
+     *
+     * The distances are compared in single precision with the threshold rounded to a float, so a pair whose
+     * distance is within a relative 6e-8 of the threshold may differ from the graph of PairwiseConsistency,
+     * which compares in double precision. The edges are the same as those of computePackedConsistencyMatrix.
+     *
+     * @param threshold Threshold on the squared Mahalanobis distance, at most the maximum threshold
+     * @returns the graph of the pairs with a distance lower than the threshold
+     */
+    ConsistencyGraph computeConsistencyGraph(const double& threshold) const;
+
+    /**
+     * \brief Packed consistency matrix for a threshold
+     *
+     * As for computeConsistencyGraph, the distances are compared in single precision with the threshold rounded
+     * to a float, within a relative 6e-8 of the comparison in double precision of PairwiseConsistency.
+     *
+     * @param threshold Threshold on the squared Mahalanobis distance, at most the maximum threshold
+     * @returns the strict upper triangle of the consistency matrix of the pairs with a distance lower than the threshold
+     */
+    PackedConsistencyMatrix computePackedConsistencyMatrix(const double& threshold) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of bytes allocated by the distances
+     */
+    size_t getMemoryUsage() const;
+
+  private:
+    size_t nb_vertices_;///< Number of loop closures
+    double max_threshold_;///< Threshold below which the pairs are kept
+    Entries entries_;///< Pairs sorted by (u, v)
+};
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_CONSISTENCY_GRAPH_H
+#define GRAPH_UTILS_CONSISTENCY_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace graph_utils {
+
+/** \class ConsistencyGraph
+ *  \brief Undirected consistency graph of the loop closures, in compressed sparse row (CSR) format.
+ *
+ *  The vertices are the indexes of the loop closures. Each edge is stored in the adjacency lists of
+ *  its two vertices, and the adjacency lists are sorted. The memory is proportional to the number of
+ *  edges instead of the square of the number of loop closures.
+ */
+class DynamicConsistencyGraph;
+
+class ConsistencyGraph {
+  public:
+    /** \typedef Edges
+     *  \brief Buffer of edges (u, v) with u < v
+     */
+    typedef std::vector<std::pair<uint32_t, uint32_t>> Edges;
+
+    /**
+     * \brief Constructor of an empty graph
+     */
+    ConsistencyGraph();
+
+    /**
+     * \brief Builds the graph from buffers of edges, e.g. one per thread
+     *
+     * The buffers are emptied as the graph is built. An edge must appear only once in the buffers.
+     * @param nb_vertices Number of vertices
+     * @param edge_buffers Buffers of edges (u, v) with u < v < nb_vertices
+     */
+    ConsistencyGraph(const size_t& nb_vertices, std::vector<Edges>& edge_buffers);
+
+    /**
+     * \brief Compacts a graph built incrementally
+     *
+     * @param graph Graph built incrementally
+     */
+    explicit ConsistencyGraph(const DynamicConsistencyGraph& graph);
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of vertices
+     */
+    size_t getNbVertices() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of edges
+     */
+    size_t getNbEdges() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @param vertex Vertex index
+     * @returns the number of neighbors of the vertex
+     */
+    size_t getDegree(const uint32_t& vertex) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @param vertex Vertex index
+     * @returns pointer to the first of the sorted neighbors of the vertex
+     */
+    const uint32_t* beginNeighbors(const uint32_t& vertex) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @param vertex Vertex index
+     * @returns pointer past the last of the sorted neighbors of the vertex
+     */
+    const uint32_t* endNeighbors(const uint32_t& vertex) const;
+
+    /**
+     * \brief Checks if two vertices are adjacent, by binary search in the adjacency list of u
+     *
+     * @param u First vertex index
+     * @param v Second vertex index
+     * @returns true if there is an edge between u and v
+     */
+    bool hasEdge(const uint32_t& u, const uint32_t& v) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns offsets of the adjacency lists in the neighbors array (number of vertices + 1 values)
+     */
+    const std::vector<size_t>& getOffsets() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns concatenated adjacency lists
+     */
+    const std::vector<uint32_t>& getNeighbors() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of bytes allocated by the graph
+     */
+    size_t getMemoryUsage() const;
+
+  private:
+    std::vector<size_t> offsets_;///< Offsets of the adjacency lists, number of vertices + 1 values
+    std::vector<uint32_t> neighbors_;///< Concatenated sorted adjacency lists
+};
+
+/** \class DynamicConsistencyGraph
+ *  \brief Consistency graph of the loop closures to which vertices can be appended.
+ *
+ *  The loop closures arrive over time: the edges of the new vertices, to the previous ones and
+ *  between themselves, are appended to sorted adjacency lists without rebuilding the graph.
+ */
+class DynamicConsistencyGraph {
+  public:
+    /**
+     * \brief Constructor of an empty graph
+     */
+    DynamicConsistencyGraph();
+
+    /**
+     * \brief Appends vertices and their edges
+     *
+     * The buffers are emptied. An edge must appear only once in the buffers.
+     * @param nb_new_vertices Number of vertices to append
+     * @param edge_buffers Buffers of edges (u, v) with u < v, of which v is one of the new vertices
+     */
+    void addVertices(const size_t& nb_new_vertices, std::vector<ConsistencyGraph::Edges>& edge_buffers);
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of vertices
+     */
+    size_t getNbVertices() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of edges
+     */
+    size_t getNbEdges() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @param vertex Vertex index
+     * @returns the sorted neighbors of the vertex
+     */
+    const std::vector<uint32_t>& getNeighbors(const uint32_t& vertex) const;
+
+  private:
+    std::vector<std::vector<uint32_t>> adjacency_lists_;///< Sorted adjacency lists
+    size_t nb_edges_;///< Number of edges
+};
+
+}
+
+#endif
@@ -0,0 +1,83 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_G2O_PARSER_H
+#define GRAPH_UTILS_G2O_PARSER_H
+
+#include "graph_utils/graph_types.h"
+
+#include <string>
+
+namespace graph_utils {
+
+/** \brief This function parses .g2o files through a memory mapping.
+ *
+ * Same inputs and outputs as parseG2ofile, but the file is tokenized in place
+ * without per-line allocations and numbers are parsed independently of the locale.
+ * @param[in] file_name File name
+ * @param[out] num_poses Number of poses in the file
+ * @param[out] transforms Structure containing the measurements
+ * @param[out] loop_closures IDs of the nodes involved to loop closures
+ * @param[in] only_loop_closures If true, the file is expected to contain only loop closures
+ * @return the degrees of freedom (3 in 2D, 6 in 3D)
+ */
+uint8_t parseG2ofileMapped(const std::string &file_name, size_t &num_poses,
+    Transforms& transforms,
+    LoopClosures& loop_closures,
+    const bool& only_loop_closures);
+
+/** \brief This function parses .g2o files on multiple threads.
+ *
+ * The memory mapped file is split at line boundaries into one chunk per thread and each
+ * chunk is tokenized in its own edge buffer. The buffers are then merged in file order,
+ * which classifies odometry and loop closures exactly as the sequential parsers do.
+ * @param[in] file_name File name
+ * @param[out] num_poses Number of poses in the file
+ * @param[out] transforms Structure containing the measurements
+ * @param[out] loop_closures IDs of the nodes involved to loop closures
+ * @param[in] only_loop_closures If true, the file is expected to contain only loop closures
+ * @param[in] nb_threads Number of threads, 0 to use all the hardware threads
+ * @return the degrees of freedom (3 in 2D, 6 in 3D)
+ */
+uint8_t parseG2ofileParallel(const std::string &file_name, size_t &num_poses,
+    Transforms& transforms,
+    LoopClosures& loop_closures,
+    const bool& only_loop_closures,
+    size_t nb_threads = 0);
+
+/** \brief This function fills a transform from the fields of an EDGE_SE2 line.
+ *
+ * @param[in] i,j IDs of the poses
+ * @param[in] measurement Raw measurement (dx dy dtheta)
+ * @param[in] information Upper triangle of the information matrix (I11 I12 I13 I22 I23 I33)
+ * @param[out] transform Transform to fill
+ */
+void fillTransformSE2(const size_t& i, const size_t& j, const double* measurement,
+    const double* information, Transform& transform);
+
+/** \brief This function fills a transform from the fields of an EDGE_SE3:QUAT line.
+ *
+ * @param[in] i,j IDs of the poses
+ * @param[in] measurement Raw measurement (dx dy dz dqx dqy dqz dqw)
+ * @param[in] information Upper triangle of the information matrix (I11 I12 ... I16 I22 ... I66)
+ * @param[out] transform Transform to fill
+ */
+void fillTransformSE3(const size_t& i, const size_t& j, const double* measurement,
+    const double* information, Transform& transform);
+
+/** \brief This function classifies a parsed transform as odometry or loop closure and stores it.
+ *
+ * A transform is a loop closure if it does not extend the chain of poses seen so far.
+ * @param[in,out] transform Parsed transform, its loop closure flag is updated
+ * @param[in,out] num_poses Largest pose ID seen so far on the odometry chain
+ * @param[in,out] is_first_transform True until the first transform is stored
+ * @param[out] transforms Structure containing the measurements
+ * @param[out] loop_closures IDs of the nodes involved to loop closures
+ * @param[in] only_loop_closures If true, every transform is a loop closure
+ */
+void storeParsedTransform(Transform& transform, size_t& num_poses, bool& is_first_transform,
+    Transforms& transforms, LoopClosures& loop_closures,
+    const bool& only_loop_closures);
+
+}
+
+#endif
@@ -4,8 +4,8 @@
 #define GRAPH_UTILS_TYPES_H
 
 #include "geometry_msgs/PoseWithCovariance.h"
+#include "graph_utils/transform_store.h"
 
-#include <map>
 #include <vector>
 
 /** \namespace graph_utils
@@ -23,11 +23,11 @@ struct Transform {
 };
 
 /** \struct Transforms
- *  \brief Structure defining a std::map of transformations
+ *  \brief Structure defining a set of transformations indexed by their pair of pose IDs
  */
 struct Transforms {
     size_t start_id, end_id;
-    std::map<std::pair<size_t,size_t>, graph_utils::Transform> transforms;
+    graph_utils::TransformStore transforms;
 };
 
 /** \struct TrajectoryPose
@@ -40,10 +40,12 @@ struct TrajectoryPose {
 
 /** \struct Trajectory
  *  \brief Structure defining a robot trajectory
+ *
+ *  The poses are stored contiguously and the pose with ID id is at index id - start_id.
  */
 struct Trajectory {
-    size_t start_id, end_id;
-    std::map<size_t, graph_utils::TrajectoryPose> trajectory_poses;
+    size_t start_id = 0, end_id = 0;
+    std::vector<graph_utils::TrajectoryPose> trajectory_poses;
 };
 
 /** \typedef LoopClosures
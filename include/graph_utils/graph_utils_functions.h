@@ -4,6 +4,8 @@
 #define GRAPH_UTILS_FUNCTIONS_H
 
 #include "graph_utils/graph_types.h"
+#include "graph_utils/consistency_graph.h"
+#include "graph_utils/packed_consistency_matrix.h"
 #include <mrpt/poses/CPose3D.h>
 #include <mrpt/poses/CPose3DPDFGaussian.h>
 #include <mrpt_bridge/pose.h>
@@ -30,7 +32,8 @@ uint8_t parseG2ofile(const std::string &file_name, size_t &num_poses,
 
 /** \brief This function compose (+) geometric poses with covariance.
  *
- * Uses the mrpt library : https://www.mrpt.org/
+ * Uses the mrpt library : https://www.mrpt.org/, or the closed-form Jacobians of
+ * graph_utils/pose_algebra.h when built with USE_NATIVE_POSE_ALGEBRA.
  * @param[in] a,b Geometric poses with covariance information
  * @param[out] out a + b
  */
@@ -40,7 +43,8 @@ void poseCompose(const geometry_msgs::PoseWithCovariance &a,
 
 /** \brief This function compose (-) geometric poses with covariance.
  *
- * Uses the mrpt library : https://www.mrpt.org/
+ * Uses the mrpt library : https://www.mrpt.org/, or the closed-form Jacobians of
+ * graph_utils/pose_algebra.h when built with USE_NATIVE_POSE_ALGEBRA.
  * @param[in] a,b Geometric poses with covariance information
  * @param[out] out a - b
  */
@@ -50,7 +54,8 @@ void poseInverseCompose(const geometry_msgs::PoseWithCovariance &a,
 
 /** \brief This function invert a geometric pose with covariance.
  *
- * Uses the mrpt library : https://www.mrpt.org/
+ * Uses the mrpt library : https://www.mrpt.org/, or the closed-form Jacobians of
+ * graph_utils/pose_algebra.h when built with USE_NATIVE_POSE_ALGEBRA.
  * @param[in] a Geometric poses with covariance information
  * @param[out] out I - a
  */
@@ -74,13 +79,43 @@ Trajectory buildTrajectory(const Transforms& transforms);
  */
 void printConsistencyGraph(const Eigen::MatrixXi& consistency_matrix, const std::string& file_name);
 
+/** \brief This function prints the sparse consistency graph to the format expected by the maximum clique solver
+ *
+ * The file is identical to the one of the consistency matrix with the same consistent pairs.
+ * @param[in] consistency_graph Consistency graph of the loop closures
+ * @param[in] file_name Name of the file in which the consistency graph will be saved
+ */
+void printConsistencyGraph(const ConsistencyGraph& consistency_graph, const std::string& file_name);
+
+/** \brief This function prints the packed consistency matrix to the format expected by the maximum clique solver
+ *
+ * The file is identical to the one of the consistency matrix with the same consistent pairs.
+ * @param[in] consistency_matrix Strict upper triangle of the consistency matrix of the loop closures
+ * @param[in] file_name Name of the file in which the consistency matrix will be saved
+ */
+void printConsistencyGraph(const PackedConsistencyMatrix& consistency_matrix, const std::string& file_name);
+
 /** \brief This function check if a pose is include in a trajectory.
  *
+ * The poses of a trajectory are contiguous, so this is a range check.
  * @param[in] trajectory Trajectory in which to find the pose
  * @param[in] pose_id ID of the pose to find.
  * returns boolean indicating if the pose is included in the trajectory.
 */
-bool isInTrajectory(const Trajectory& trajectory, const size_t& pose_id);
+inline bool isInTrajectory(const Trajectory& trajectory, const size_t& pose_id) {
+  // IDs lower than start_id wrap around and fail the comparison
+  return pose_id - trajectory.start_id < trajectory.trajectory_poses.size();
+}
+
+/** \brief This function returns a pose of a trajectory.
+ *
+ * @param[in] trajectory Trajectory containing the pose
+ * @param[in] pose_id ID of the pose, must be in the trajectory (see isInTrajectory).
+ * returns the pose.
+*/
+inline const TrajectoryPose& getTrajectoryPose(const Trajectory& trajectory, const size_t& pose_id) {
+  return trajectory.trajectory_poses[pose_id - trajectory.start_id];
+}
 
 /** \brief This function prints a list of consistent loop closures in a file.
 *
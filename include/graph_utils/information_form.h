@@ -0,0 +1,49 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_INFORMATION_FORM_H
+#define GRAPH_UTILS_INFORMATION_FORM_H
+
+#include <eigen3/Eigen/Dense>
+
+namespace graph_utils {
+
+/** \brief Squared Mahalanobis distance computed with an explicit inverse of the covariance.
+ *
+ * Reference implementation, kept for validation.
+ * @param[in] residual Residual vector
+ * @param[in] covariance Covariance of the residual
+ * @return residual^T * covariance^-1 * residual
+ */
+template <int Dim>
+double squaredMahalanobisDistanceExplicitInverse(const Eigen::Matrix<double, Dim, 1>& residual,
+                                                 const Eigen::Matrix<double, Dim, Dim>& covariance) {
+    return residual.transpose() * covariance.inverse() * residual;
+}
+
+/** \brief Squared Mahalanobis distance computed in information form.
+ *
+ * With the Cholesky factorization covariance = L * L^T, the distance is the squared norm of
+ * L^-1 * residual, obtained by a single triangular solve. If the covariance is not positive
+ * definite, the explicit inverse is used so that the decisions stay the same. Up to 3x3, Eigen
+ * inverts the fixed-size matrices with cofactors, which is cheaper than the factorization, so
+ * the explicit inverse is used as well.
+ * @param[in] residual Residual vector
+ * @param[in] covariance Covariance of the residual
+ * @return residual^T * covariance^-1 * residual
+ */
+template <int Dim>
+double squaredMahalanobisDistance(const Eigen::Matrix<double, Dim, 1>& residual,
+                                  const Eigen::Matrix<double, Dim, Dim>& covariance) {
+    if (Dim <= 3) {
+        return squaredMahalanobisDistanceExplicitInverse<Dim>(residual, covariance);
+    }
+    const Eigen::LLT<Eigen::Matrix<double, Dim, Dim>> cholesky(covariance);
+    if (cholesky.info() != Eigen::Success) {
+        return squaredMahalanobisDistanceExplicitInverse<Dim>(residual, covariance);
+    }
+    return cholesky.matrixL().solve(residual).squaredNorm();
+}
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_MAPPED_FILE_H
+#define GRAPH_UTILS_MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+namespace graph_utils {
+
+    /** \class MappedFile
+     *  \brief Read-only memory mapping of a whole file.
+     *
+     *  The mapping is released when the object is destroyed.
+     */
+    class MappedFile {
+      public:
+        /**
+         * \brief Constructor, maps the file in memory
+         *
+         * @param file_name Name of the file to map
+         */
+        explicit MappedFile(const std::string& file_name);
+
+        /**
+         * \brief Destructor, unmaps the file
+         */
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns true if the file was successfully mapped
+         */
+        bool isOpen() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns pointer to the first byte of the file
+         */
+        const char* data() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns size of the file in bytes
+         */
+        size_t size() const;
+
+      private:
+        int file_descriptor_; ///< Descriptor of the mapped file.
+        const char* data_; ///< Start of the mapping.
+        size_t size_; ///< Size of the mapping.
+        bool is_open_; ///< Whether the file could be mapped.
+    };
+}
+
+#endif
@@ -0,0 +1,80 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_ODOMETRY_TREE_H
+#define GRAPH_UTILS_ODOMETRY_TREE_H
+
+#include "graph_utils/graph_types.h"
+#include "graph_utils/pose_algebra.h"
+
+#include <eigen3/Eigen/StdVector>
+
+#include <cstddef>
+#include <vector>
+
+namespace graph_utils {
+
+/** \class OdometryTree
+ *  \brief Segment tree over the odometry chain of a trajectory, for the relative poses between any two of its poses.
+ *
+ *  The leaves are the odometry measurements (id, id + 1) and each node holds the composition, with its
+ *  covariance, of the measurements of its range. The relative pose between two poses is composed from
+ *  O(log n) nodes, and its covariance is the one of the odometry between them only. Composing the absolute
+ *  poses instead counts twice the uncertainty of the odometry before the first pose, which both poses share.
+ *  Templated on the pose type (PoseSE2 or PoseSE3).
+ */
+template <typename Pose>
+class OdometryTree {
+  public:
+    /**
+     * \brief Constructor of an empty tree
+     */
+    OdometryTree();
+
+    /**
+     * \brief Constructor
+     *
+     * The odometry chain starts at start_id and stops at the first missing odometry measurement,
+     * as the trajectory computed by buildTrajectory.
+     *
+     * @param transforms Odometry measurements of a robot
+     */
+    explicit OdometryTree(const Transforms& transforms);
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of poses of the odometry chain, one more than the number of measurements
+     */
+    size_t getNbPoses() const;
+
+    /**
+     * \brief Relative pose Xindex1^-1 + Xindex2, composed from the odometry between the poses
+     *
+     * Can be called by several threads at the same time.
+     *
+     * @param index1 Index of the first pose in the trajectory, id - start_id
+     * @param index2 Index of the second pose in the trajectory, id - start_id
+     * @param result Relative pose, the inverse of the composition of the odometry if index1 > index2
+     */
+    void getRelativePose(const size_t& index1, const size_t& index2, Pose& result) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of bytes allocated by the tree
+     */
+    size_t getMemoryUsage() const;
+
+  private:
+    /**
+     * \brief Composition of the odometry measurements first to end - 1, first < end
+     */
+    void composeOdometry(size_t first, size_t end, Pose& result) const;
+
+    size_t nb_measurements_;///< Number of odometry measurements
+    std::vector<Pose, Eigen::aligned_allocator<Pose>> nodes_;///< Node k composes the nodes 2k and 2k + 1, the leaves start at nb_measurements_
+};
+
+}
+
+#endif
@@ -0,0 +1,174 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_PACKED_CONSISTENCY_MATRIX_H
+#define GRAPH_UTILS_PACKED_CONSISTENCY_MATRIX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace graph_utils {
+
+/** \class PackedConsistencyMatrix
+ *  \brief Strict upper triangle of the consistency matrix of the loop closures, packed in bits.
+ *
+ *  The m(m-1)/2 entries (u, v), u < v, are stored row after row in 64-bit words, one bit per
+ *  entry, which is 32 times smaller than a dense matrix of int. Preferable to the sparse
+ *  ConsistencyGraph when most of the loop closures are consistent.
+ */
+class PackedConsistencyMatrix {
+  public:
+    /** \class RowView
+     *  \brief Read-only view of the entries (u, v), v > u, of a row u
+     */
+    class RowView {
+      public:
+        /**
+         * \brief Constructor
+         *
+         * @param words Words of the matrix
+         * @param first_bit Index of the bit of the first entry of the row
+         * @param first_column Column of the first entry of the row (u + 1)
+         * @param end_column Number of columns of the matrix
+         */
+        RowView(const uint64_t* words, const size_t& first_bit, const size_t& first_column, const size_t& end_column);
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the column of the first entry of the row (u + 1)
+         */
+        size_t getFirstColumn() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the number of columns of the matrix
+         */
+        size_t getEndColumn() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @param column Column, in [getFirstColumn(), getEndColumn())
+         * @returns true if the entry is set
+         */
+        bool test(const size_t& column) const;
+
+        /**
+         * \brief Entries of 64 consecutive columns of the row
+         *
+         * @param column First column, in [getFirstColumn(), getEndColumn())
+         * @returns the entries of the columns column to column + 63 in the bits 0 to 63, 0 past the end of the row
+         */
+        uint64_t getWord(const size_t& column) const;
+
+        /**
+         * \brief Number of entries set in the row
+         *
+         * @returns the number of neighbors v > u of the vertex u
+         */
+        size_t count() const;
+
+      private:
+        const uint64_t* words_;///< Words of the matrix
+        size_t first_bit_;///< Index of the bit of the first entry of the row
+        size_t first_column_, end_column_;///< Columns of the row
+    };
+
+    /**
+     * \brief Constructor of an empty matrix
+     */
+    PackedConsistencyMatrix();
+
+    /**
+     * \brief Constructor of a matrix without consistent pairs
+     *
+     * @param nb_vertices Number of loop closures
+     */
+    explicit PackedConsistencyMatrix(const size_t& nb_vertices);
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of loop closures
+     */
+    size_t getNbVertices() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of consistent pairs
+     */
+    size_t getNbEdges() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @param u First loop closure index
+     * @param v Second loop closure index
+     * @returns true if the loop closures are consistent, the order of u and v does not matter
+     */
+    bool test(const size_t& u, const size_t& v) const;
+
+    /**
+     * \brief Marks a pair of loop closures as consistent
+     *
+     * @param u First loop closure index
+     * @param v Second loop closure index, v > u
+     */
+    void set(const size_t& u, const size_t& v);
+
+    /**
+     * \brief Marks a pair of loop closures as consistent, can be called by several threads at the same time
+     *
+     * @param u First loop closure index
+     * @param v Second loop closure index, v > u
+     */
+    void setConcurrently(const size_t& u, const size_t& v);
+
+    /**
+     * \brief Accessor
+     *
+     * @param u Loop closure index
+     * @returns the view of the entries (u, v), v > u
+     */
+    RowView getRow(const size_t& u) const;
+
+    /**
+     * \brief Degrees of the vertices of the consistency graph, counted by popcount
+     *
+     * @returns the number of loop closures consistent with each loop closure
+     */
+    std::vector<size_t> computeDegrees() const;
+
+    /**
+     * \brief Word-wise intersection of two rows
+     *
+     * @param u First loop closure index
+     * @param w Second loop closure index, different from u
+     * @param common Common neighbors v > max(u, w), the bit b of the word k is the column max(u, w) + 1 + 64 k + b
+     * @returns the number of common neighbors v > max(u, w)
+     */
+    size_t intersectRows(const size_t& u, const size_t& w, std::vector<uint64_t>& common) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of bytes allocated by the matrix
+     */
+    size_t getMemoryUsage() const;
+
+  private:
+    /**
+     * \brief Index of the bit of the entry (u, v), u < v
+     */
+    size_t getBitIndex(const size_t& u, const size_t& v) const;
+
+    size_t nb_vertices_;///< Number of loop closures
+    std::vector<uint64_t> words_;///< Packed rows, followed by a padding word
+};
+
+}
+
+#endif
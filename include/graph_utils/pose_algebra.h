@@ -0,0 +1,412 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_POSE_ALGEBRA_H
+#define GRAPH_UTILS_POSE_ALGEBRA_H
+
+#include "geometry_msgs/PoseWithCovariance.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <eigen3/Eigen/Dense>
+
+namespace graph_utils {
+
+/** \struct PoseSE2
+ *  \brief Planar pose with its covariance.
+ */
+struct PoseSE2 {
+    Eigen::Vector3d mean; ///< x, y, yaw
+    Eigen::Matrix3d covariance; ///< Covariance of (x, y, yaw)
+};
+
+/** \struct PoseSE3
+ *  \brief 3D pose with its covariance.
+ *
+ *  As in MRPT, the covariance is expressed on (x, y, z, yaw, pitch, roll), where the rotation
+ *  is Rz(yaw) * Ry(pitch) * Rx(roll).
+ */
+struct PoseSE3 {
+    Eigen::Vector3d translation; ///< x, y, z
+    Eigen::Matrix3d rotation; ///< Rotation matrix
+    double yaw, pitch, roll; ///< Euler angles of the rotation
+    Eigen::Matrix<double, 6, 6> covariance; ///< Covariance of (x, y, z, yaw, pitch, roll)
+};
+
+namespace internal {
+
+/** Rows/columns of the geometry_msgs covariance for (x, y, z, yaw, pitch, roll) */
+const int COVARIANCE_INDEXES_SE3[6] = {0, 1, 2, 5, 4, 3};
+
+/** Rows/columns of the geometry_msgs covariance for (x, y, yaw) */
+const int COVARIANCE_INDEXES_SE2[3] = {0, 1, 5};
+
+/** Wraps an angle to ]-pi, pi] */
+inline double wrapAngle(double angle) {
+    while (angle > M_PI) {
+        angle -= 2 * M_PI;
+    }
+    while (angle <= -M_PI) {
+        angle += 2 * M_PI;
+    }
+    return angle;
+}
+
+inline Eigen::Matrix3d skew(const Eigen::Vector3d& v) {
+    Eigen::Matrix3d m;
+    m << 0, -v(2), v(1),
+         v(2), 0, -v(0),
+         -v(1), v(0), 0;
+    return m;
+}
+
+/** Cosine and sine of the yaw and of the pitch of a rotation matrix, without trigonometric functions */
+inline void yawPitchCosSin(const Eigen::Matrix3d& rotation, double& cy, double& sy, double& cp, double& sp) {
+    // The first column is (cos(yaw) * cos(pitch), sin(yaw) * cos(pitch), -sin(pitch))
+    const double norm_xy = std::hypot(rotation(0, 0), rotation(1, 0));
+    const double norm = std::hypot(norm_xy, rotation(2, 0));
+    cy = rotation(0, 0) / norm_xy;
+    sy = rotation(1, 0) / norm_xy;
+    cp = norm_xy / norm;
+    sp = -rotation(2, 0) / norm;
+}
+
+/** Maps the rates of (yaw, pitch, roll) to the angular velocity, expressed in the fixed frame */
+inline Eigen::Matrix3d eulerRatesToAngularVelocity(const Eigen::Matrix3d& rotation) {
+    double cy, sy, cp, sp;
+    yawPitchCosSin(rotation, cy, sy, cp, sp);
+    Eigen::Matrix3d m;
+    m << 0, -sy, cy * cp,
+         0, cy, sy * cp,
+         1, 0, -sp;
+    return m;
+}
+
+/** Inverse of eulerRatesToAngularVelocity, singular when the pitch is +-pi/2 */
+inline Eigen::Matrix3d angularVelocityToEulerRates(const Eigen::Matrix3d& rotation) {
+    double cy, sy, cp, sp;
+    yawPitchCosSin(rotation, cy, sy, cp, sp);
+    const double tp = sp / cp;
+    Eigen::Matrix3d m;
+    m << cy * tp, sy * tp, 1,
+         -sy, cy, 0,
+         cy / cp, sy / cp, 0;
+    return m;
+}
+
+/** Euler angles of the rotation matrix, computed as mrpt::poses::CPose3D does */
+inline void updateYawPitchRoll(PoseSE3& pose) {
+    const Eigen::Matrix3d& r = pose.rotation;
+    pose.pitch = std::atan2(-r(2, 0), std::hypot(r(0, 0), r(1, 0)));
+    if (std::abs(r(2, 1)) + std::abs(r(2, 2)) < 10 * std::numeric_limits<double>::epsilon()) {
+        // Gimbal lock, the roll is arbitrarily set to zero
+        pose.roll = 0;
+        if (pose.pitch > 0) {
+            pose.yaw = std::atan2(r(1, 2), r(0, 2));
+        } else {
+            pose.yaw = std::atan2(-r(1, 2), -r(0, 2));
+        }
+    } else {
+        pose.roll = std::atan2(r(2, 1), r(2, 2));
+        pose.yaw = std::atan2(r(1, 0), r(0, 0));
+    }
+}
+
+}
+
+/** \brief This function converts a pose with covariance to a planar pose.
+ *
+ * Only x, y, the yaw and their covariance are kept.
+ * @param[in] pose Pose with covariance
+ * @param[out] out Planar pose
+ */
+inline void fromPoseWithCovariance(const geometry_msgs::PoseWithCovariance& pose, PoseSE2& out) {
+    const geometry_msgs::Quaternion& q = pose.pose.orientation;
+    out.mean << pose.pose.position.x, pose.pose.position.y,
+                std::atan2(2 * (q.w * q.z + q.x * q.y), q.w * q.w + q.x * q.x - q.y * q.y - q.z * q.z);
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            out.covariance(row, col) = pose.covariance[internal::COVARIANCE_INDEXES_SE2[row] * 6 + internal::COVARIANCE_INDEXES_SE2[col]];
+        }
+    }
+}
+
+/** \brief This function converts a planar pose to a pose with covariance.
+ *
+ * @param[in] pose Planar pose
+ * @param[out] out Pose with covariance
+ */
+inline void toPoseWithCovariance(const PoseSE2& pose, geometry_msgs::PoseWithCovariance& out) {
+    out.pose.position.x = pose.mean(0);
+    out.pose.position.y = pose.mean(1);
+    out.pose.position.z = 0;
+    out.pose.orientation.x = 0;
+    out.pose.orientation.y = 0;
+    out.pose.orientation.z = std::sin(pose.mean(2) / 2);
+    out.pose.orientation.w = std::cos(pose.mean(2) / 2);
+    std::fill(out.covariance.begin(), out.covariance.end(), 0.0);
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            out.covariance[internal::COVARIANCE_INDEXES_SE2[row] * 6 + internal::COVARIANCE_INDEXES_SE2[col]] = pose.covariance(row, col);
+        }
+    }
+}
+
+/** \brief This function converts a pose with covariance to a 3D pose.
+ *
+ * Same conversion as mrpt_bridge, the quaternion is not normalized.
+ * @param[in] pose Pose with covariance
+ * @param[out] out 3D pose
+ */
+inline void fromPoseWithCovariance(const geometry_msgs::PoseWithCovariance& pose, PoseSE3& out) {
+    const geometry_msgs::Quaternion& q = pose.pose.orientation;
+    out.translation << pose.pose.position.x, pose.pose.position.y, pose.pose.position.z;
+    out.rotation << q.w * q.w + q.x * q.x - q.y * q.y - q.z * q.z, 2 * (q.x * q.y - q.w * q.z), 2 * (q.z * q.x + q.w * q.y),
+                    2 * (q.x * q.y + q.w * q.z), q.w * q.w - q.x * q.x + q.y * q.y - q.z * q.z, 2 * (q.y * q.z - q.w * q.x),
+                    2 * (q.z * q.x - q.w * q.y), 2 * (q.y * q.z + q.w * q.x), q.w * q.w - q.x * q.x - q.y * q.y + q.z * q.z;
+    internal::updateYawPitchRoll(out);
+    for (int row = 0; row < 6; row++) {
+        for (int col = 0; col < 6; col++) {
+            out.covariance(row, col) = pose.covariance[internal::COVARIANCE_INDEXES_SE3[row] * 6 + internal::COVARIANCE_INDEXES_SE3[col]];
+        }
+    }
+}
+
+/** \brief This function computes the quaternion of a 3D pose from its Euler angles, as mrpt::poses::CPose3D does.
+ *
+ * @param[in] pose 3D pose
+ * @param[out] q Quaternion
+ */
+inline void getQuaternion(const PoseSE3& pose, geometry_msgs::Quaternion& q) {
+    const double cy = std::cos(pose.yaw / 2), sy = std::sin(pose.yaw / 2);
+    const double cp = std::cos(pose.pitch / 2), sp = std::sin(pose.pitch / 2);
+    const double cr = std::cos(pose.roll / 2), sr = std::sin(pose.roll / 2);
+    q.w = cr * cp * cy + sr * sp * sy;
+    q.x = sr * cp * cy - cr * sp * sy;
+    q.y = cr * sp * cy + sr * cp * sy;
+    q.z = cr * cp * sy - sr * sp * cy;
+}
+
+/** \brief This function converts a 3D pose to a pose with covariance.
+ *
+ * @param[in] pose 3D pose
+ * @param[out] out Pose with covariance
+ */
+inline void toPoseWithCovariance(const PoseSE3& pose, geometry_msgs::PoseWithCovariance& out) {
+    out.pose.position.x = pose.translation(0);
+    out.pose.position.y = pose.translation(1);
+    out.pose.position.z = pose.translation(2);
+    getQuaternion(pose, out.pose.orientation);
+    for (int row = 0; row < 6; row++) {
+        for (int col = 0; col < 6; col++) {
+            out.covariance[internal::COVARIANCE_INDEXES_SE3[row] * 6 + internal::COVARIANCE_INDEXES_SE3[col]] = pose.covariance(row, col);
+        }
+    }
+}
+
+/** \brief Composition a (+) b of two independent planar poses.
+ *
+ * The covariance is propagated to the first order with the closed-form Jacobians.
+ * @param[in] a First pose
+ * @param[in] b Second pose
+ * @param[out] out Result, may alias an input
+ */
+inline void composeSE2(const PoseSE2& a, const PoseSE2& b, PoseSE2& out) {
+    const double c = std::cos(a.mean(2)), s = std::sin(a.mean(2));
+    Eigen::Matrix3d j_a, j_b;
+    j_a << 1, 0, -s * b.mean(0) - c * b.mean(1),
+           0, 1, c * b.mean(0) - s * b.mean(1),
+           0, 0, 1;
+    j_b << c, -s, 0,
+           s, c, 0,
+           0, 0, 1;
+    const Eigen::Matrix3d covariance = j_a * a.covariance * j_a.transpose() + j_b * b.covariance * j_b.transpose();
+    out.mean << a.mean(0) + c * b.mean(0) - s * b.mean(1),
+                a.mean(1) + s * b.mean(0) + c * b.mean(1),
+                internal::wrapAngle(a.mean(2) + b.mean(2));
+    out.covariance = covariance;
+}
+
+/** \brief Inverse composition a (-) b = inverse(b) (+) a of two independent planar poses.
+ *
+ * @param[in] a First pose
+ * @param[in] b Second pose
+ * @param[out] out Result, may alias an input
+ */
+inline void inverseComposeSE2(const PoseSE2& a, const PoseSE2& b, PoseSE2& out) {
+    const double c = std::cos(b.mean(2)), s = std::sin(b.mean(2));
+    const double dx = a.mean(0) - b.mean(0), dy = a.mean(1) - b.mean(1);
+    const Eigen::Vector3d mean(c * dx + s * dy, -s * dx + c * dy, internal::wrapAngle(a.mean(2) - b.mean(2)));
+    Eigen::Matrix3d j_a, j_b;
+    j_a << c, s, 0,
+           -s, c, 0,
+           0, 0, 1;
+    j_b << -c, -s, mean(1),
+           s, -c, -mean(0),
+           0, 0, -1;
+    out.covariance = j_a * a.covariance * j_a.transpose() + j_b * b.covariance * j_b.transpose();
+    out.mean = mean;
+}
+
+/** \brief Inverse of a planar pose.
+ *
+ * @param[in] a Pose
+ * @param[out] out Result, may alias the input
+ */
+inline void inverseSE2(const PoseSE2& a, PoseSE2& out) {
+    const double c = std::cos(a.mean(2)), s = std::sin(a.mean(2));
+    const Eigen::Vector3d mean(-c * a.mean(0) - s * a.mean(1), s * a.mean(0) - c * a.mean(1), internal::wrapAngle(-a.mean(2)));
+    Eigen::Matrix3d j;
+    j << -c, -s, mean(1),
+         s, -c, -mean(0),
+         0, 0, -1;
+    out.covariance = j * a.covariance * j.transpose();
+    out.mean = mean;
+}
+
+/** \brief Composition a (+) b of two independent 3D poses.
+ *
+ * The covariance is propagated to the first order with the closed-form Jacobians
+ * with respect to (x, y, z, yaw, pitch, roll), like mrpt::poses::CPose3DPDFGaussian.
+ * @param[in] a First pose
+ * @param[in] b Second pose
+ * @param[out] out Result, may alias an input
+ */
+inline void composeSE3(const PoseSE3& a, const PoseSE3& b, PoseSE3& out) {
+    PoseSE3 result;
+    const Eigen::Vector3d rotated_translation = a.rotation * b.translation;
+    result.translation = a.translation + rotated_translation;
+    result.rotation = a.rotation * b.rotation;
+    internal::updateYawPitchRoll(result);
+
+    const Eigen::Matrix3d to_rates = internal::angularVelocityToEulerRates(result.rotation);
+    const Eigen::Matrix3d from_rates_a = internal::eulerRatesToAngularVelocity(a.rotation);
+    Eigen::Matrix<double, 6, 6> j_a = Eigen::Matrix<double, 6, 6>::Identity();
+    Eigen::Matrix<double, 6, 6> j_b = Eigen::Matrix<double, 6, 6>::Zero();
+    j_a.topRightCorner<3, 3>() = -internal::skew(rotated_translation) * from_rates_a;
+    j_a.bottomRightCorner<3, 3>() = to_rates * from_rates_a;
+    j_b.topLeftCorner<3, 3>() = a.rotation;
+    j_b.bottomRightCorner<3, 3>() = to_rates * a.rotation * internal::eulerRatesToAngularVelocity(b.rotation);
+    result.covariance = j_a * a.covariance * j_a.transpose() + j_b * b.covariance * j_b.transpose();
+    out = result;
+}
+
+/** \brief Inverse composition a (-) b = inverse(b) (+) a of two independent 3D poses.
+ *
+ * @param[in] a First pose
+ * @param[in] b Second pose
+ * @param[out] out Result, may alias an input
+ */
+inline void inverseComposeSE3(const PoseSE3& a, const PoseSE3& b, PoseSE3& out) {
+    PoseSE3 result;
+    const Eigen::Matrix3d inverse_rotation_b = b.rotation.transpose();
+    const Eigen::Vector3d difference = a.translation - b.translation;
+    result.translation = inverse_rotation_b * difference;
+    result.rotation = inverse_rotation_b * a.rotation;
+    internal::updateYawPitchRoll(result);
+
+    const Eigen::Matrix3d to_rates = internal::angularVelocityToEulerRates(result.rotation);
+    const Eigen::Matrix3d from_rates_b = internal::eulerRatesToAngularVelocity(b.rotation);
+    Eigen::Matrix<double, 6, 6> j_a = Eigen::Matrix<double, 6, 6>::Zero();
+    Eigen::Matrix<double, 6, 6> j_b = Eigen::Matrix<double, 6, 6>::Zero();
+    j_a.topLeftCorner<3, 3>() = inverse_rotation_b;
+    j_a.bottomRightCorner<3, 3>() = to_rates * inverse_rotation_b * internal::eulerRatesToAngularVelocity(a.rotation);
+    j_b.topLeftCorner<3, 3>() = -inverse_rotation_b;
+    j_b.topRightCorner<3, 3>() = inverse_rotation_b * internal::skew(difference) * from_rates_b;
+    j_b.bottomRightCorner<3, 3>() = -to_rates * inverse_rotation_b * from_rates_b;
+    result.covariance = j_a * a.covariance * j_a.transpose() + j_b * b.covariance * j_b.transpose();
+    out = result;
+}
+
+/** \brief Inverse of a 3D pose.
+ *
+ * @param[in] a Pose
+ * @param[out] out Result, may alias the input
+ */
+inline void inverseSE3(const PoseSE3& a, PoseSE3& out) {
+    PoseSE3 result;
+    const Eigen::Matrix3d inverse_rotation = a.rotation.transpose();
+    result.translation = -inverse_rotation * a.translation;
+    result.rotation = inverse_rotation;
+    internal::updateYawPitchRoll(result);
+
+    const Eigen::Matrix3d from_rates = internal::eulerRatesToAngularVelocity(a.rotation);
+    Eigen::Matrix<double, 6, 6> j = Eigen::Matrix<double, 6, 6>::Zero();
+    j.topLeftCorner<3, 3>() = -inverse_rotation;
+    j.topRightCorner<3, 3>() = -inverse_rotation * internal::skew(a.translation) * from_rates;
+    j.bottomRightCorner<3, 3>() = -internal::angularVelocityToEulerRates(result.rotation) * inverse_rotation * from_rates;
+    result.covariance = j * a.covariance * j.transpose();
+    out = result;
+}
+
+/** \struct PoseTraits
+ *  \brief Dimension of the covariance of a pose type, 3 for PoseSE2 and 6 for PoseSE3, and type of its mean
+ *  as a rigid transformation.
+ *
+ *  With the overloads of compose, inverseCompose and inverse below, code templated on the
+ *  pose type runs with fixed-size kernels in 2D and in 3D. Like poseCompose, poseInverseCompose
+ *  and poseInverse, these overloads use the closed-form Jacobians above when built with
+ *  USE_NATIVE_POSE_ALGEBRA, and MRPT otherwise (defined in graph_utils_functions.cpp).
+ */
+template <typename Pose>
+struct PoseTraits;
+
+template <>
+struct PoseTraits<PoseSE2> {
+    static const int DIMENSION = 3;
+    typedef Eigen::Isometry2d Isometry;
+};
+
+template <>
+struct PoseTraits<PoseSE3> {
+    static const int DIMENSION = 6;
+    typedef Eigen::Isometry3d Isometry;
+};
+
+#ifdef USE_NATIVE_POSE_ALGEBRA
+inline void compose(const PoseSE2& a, const PoseSE2& b, PoseSE2& out) {
+    composeSE2(a, b, out);
+}
+
+inline void compose(const PoseSE3& a, const PoseSE3& b, PoseSE3& out) {
+    composeSE3(a, b, out);
+}
+
+inline void inverseCompose(const PoseSE2& a, const PoseSE2& b, PoseSE2& out) {
+    inverseComposeSE2(a, b, out);
+}
+
+inline void inverseCompose(const PoseSE3& a, const PoseSE3& b, PoseSE3& out) {
+    inverseComposeSE3(a, b, out);
+}
+
+inline void inverse(const PoseSE2& a, PoseSE2& out) {
+    inverseSE2(a, out);
+}
+
+inline void inverse(const PoseSE3& a, PoseSE3& out) {
+    inverseSE3(a, out);
+}
+#else
+/** \brief Composition a (+) b with MRPT, the planar poses are composed as 3D poses */
+void compose(const PoseSE2& a, const PoseSE2& b, PoseSE2& out);
+
+/** \brief Composition a (+) b with MRPT */
+void compose(const PoseSE3& a, const PoseSE3& b, PoseSE3& out);
+
+/** \brief Inverse composition a (-) b with MRPT, the planar poses are composed as 3D poses */
+void inverseCompose(const PoseSE2& a, const PoseSE2& b, PoseSE2& out);
+
+/** \brief Inverse composition a (-) b with MRPT */
+void inverseCompose(const PoseSE3& a, const PoseSE3& b, PoseSE3& out);
+
+/** \brief Inverse with MRPT, the planar pose is inverted as a 3D pose */
+void inverse(const PoseSE2& a, PoseSE2& out);
+
+/** \brief Inverse with MRPT */
+void inverse(const PoseSE3& a, PoseSE3& out);
+#endif
+
+}
+
+#endif
@@ -0,0 +1,160 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_POSE_GRAPH_BINARY_H
+#define GRAPH_UTILS_POSE_GRAPH_BINARY_H
+
+#include "graph_utils/graph_types.h"
+#include "graph_utils/mapped_file.h"
+
+#include <cstdint>
+#include <string>
+
+namespace graph_utils {
+
+/** \var POSE_GRAPH_BINARY_EXTENSION
+ *  \brief Extension of the binary pose graph files
+ */
+const std::string POSE_GRAPH_BINARY_EXTENSION = ".pgb";
+
+/** \var POSE_GRAPH_BINARY_VERSION
+ *  \brief Current version of the binary pose graph format
+ */
+const uint32_t POSE_GRAPH_BINARY_VERSION = 1;
+
+/** \struct PoseGraphBinaryHeader
+ *  \brief Header of a binary pose graph file.
+ *
+ *  The header is followed by three sections of fixed-size records, in native byte order :
+ *  - nb_transforms transforms : i, j, is_loop_closure (uint64), pose (x y z qx qy qz qw), covariance
+ *  - nb_trajectory_poses trajectory poses : id (uint64), pose (x y z qx qy qz qw), covariance
+ *  - nb_loop_closures loop closures : i, j (uint64)
+ *
+ *  Each covariance is stored once as the packed upper triangle, row by row, of the
+ *  3x3 (x y yaw) matrix in 2D or of the 6x6 matrix in 3D.
+ */
+struct PoseGraphBinaryHeader {
+    char magic[4]; ///< "RMPG"
+    uint32_t version; ///< Version of the format
+    uint8_t nb_degree_freedom; ///< 3 in 2D, 6 in 3D
+    uint8_t padding[7]; ///< Keeps the records aligned on 8 bytes
+    uint64_t num_poses; ///< Number of poses
+    uint64_t transforms_start_id, transforms_end_id; ///< Range of the odometry chain
+    uint64_t nb_transforms; ///< Number of transform records
+    uint64_t trajectory_start_id, trajectory_end_id; ///< Range of the trajectory
+    uint64_t nb_trajectory_poses; ///< Number of trajectory records, 0 if no trajectory was saved
+    uint64_t nb_loop_closures; ///< Number of loop closure records
+};
+
+/** \brief This function writes measurements (and optionally a trajectory) to a binary pose graph file.
+ *
+ * The transform records are written in the insertion order of the transform store.
+ *
+ * @param[in] file_name File name
+ * @param[in] num_poses Number of poses
+ * @param[in] transforms Measurements
+ * @param[in] loop_closures IDs of the nodes involved to loop closures
+ * @param[in] nb_degree_freedom Degrees of freedom of the measurements (3 in 2D, 6 in 3D)
+ * @param[in] trajectory Precomputed trajectory, not saved if it has no poses
+ * @return true if the file was written
+ */
+bool writePoseGraphBinary(const std::string& file_name, const size_t& num_poses,
+    const Transforms& transforms, const LoopClosures& loop_closures,
+    const uint8_t& nb_degree_freedom, const Trajectory& trajectory = Trajectory());
+
+/** \brief This function checks if a file name has the binary pose graph extension.
+ *
+ * @param[in] file_name File name
+ * @return true if the file is a binary pose graph
+ */
+bool isPoseGraphBinaryFile(const std::string& file_name);
+
+/** \class PoseGraphBinaryFile
+ *  \brief Memory mapped reader of binary pose graph files.
+ *
+ *  Opening a file only maps it and validates its header, the records are read on access.
+ *  Loading the measurements or the trajectory copies all the records.
+ */
+class PoseGraphBinaryFile {
+  public:
+    /**
+     * \brief Constructor, maps the file
+     *
+     * @param file_name Name of the binary pose graph file
+     */
+    explicit PoseGraphBinaryFile(const std::string& file_name);
+
+    /**
+     * \brief Accessor
+     *
+     * @returns true if the file is mapped and is a supported binary pose graph
+     */
+    bool isValid() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the header of the file
+     */
+    const PoseGraphBinaryHeader& getHeader() const;
+
+    /**
+     * \brief Reads a transform record
+     *
+     * @param index Index of the record
+     * @returns the transform
+     */
+    Transform getTransform(const size_t& index) const;
+
+    /**
+     * \brief Reads a trajectory record
+     *
+     * @param index Index of the record
+     * @returns the trajectory pose
+     */
+    TrajectoryPose getTrajectoryPose(const size_t& index) const;
+
+    /**
+     * \brief Reads a loop closure record
+     *
+     * @param index Index of the record
+     * @returns the IDs of the nodes of the loop closure
+     */
+    std::pair<size_t, size_t> getLoopClosure(const size_t& index) const;
+
+    /**
+     * \brief Fills the same outputs as parseG2ofile
+     *
+     * The records are copied into the outputs, which do not reference the mapping.
+     *
+     * @param[out] num_poses Number of poses in the file
+     * @param[out] transforms Structure containing the measurements
+     * @param[out] loop_closures IDs of the nodes involved to loop closures
+     * @returns the degrees of freedom (3 in 2D, 6 in 3D)
+     */
+    uint8_t load(size_t& num_poses, Transforms& transforms, LoopClosures& loop_closures) const;
+
+    /**
+     * \brief Fills the saved trajectory
+     *
+     * The records are copied into the trajectory.
+     *
+     * @param[out] trajectory Trajectory
+     * @returns false if the file does not contain a trajectory, or if its poses are not contiguous
+     */
+    bool loadTrajectory(Trajectory& trajectory) const;
+
+  private:
+    const char* transformRecord(const size_t& index) const;
+    const char* trajectoryRecord(const size_t& index) const;
+
+    MappedFile file_; ///< Mapping of the file.
+    PoseGraphBinaryHeader header_; ///< Copy of the header.
+    bool is_valid_; ///< Whether the file is a supported binary pose graph.
+    size_t nb_covariance_values_; ///< Number of values of a packed covariance.
+    size_t transforms_offset_, trajectory_offset_, loop_closures_offset_; ///< Offsets of the sections.
+    size_t transform_record_size_, trajectory_record_size_; ///< Sizes of the records, in bytes.
+};
+
+}
+
+#endif
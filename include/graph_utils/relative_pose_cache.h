@@ -0,0 +1,177 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_RELATIVE_POSE_CACHE_H
+#define GRAPH_UTILS_RELATIVE_POSE_CACHE_H
+
+#include <eigen3/Eigen/StdVector>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph_utils {
+
+/** \class RelativePoseCache
+ *  \brief Thread-safe memoization of the relative poses, with their covariance, between two poses of a trajectory.
+ *
+ *  The relative poses are keyed by (robot, id1, id2) and distributed over shards, each with its own
+ *  mutex, so that threads querying different keys rarely wait for each other. The cache only stores
+ *  the results : the relative pose is computed by the caller on a miss, outside of the lock, from
+ *  data that the cache does not copy. Templated on the pose type (PoseSE2 or PoseSE3).
+ *
+ *  PairwiseConsistency memoizes the 3D relative poses composed from the odometry trees. The cache pays
+ *  off when a query costs several compositions of 6x6 covariances : a planar query of the tree, or a
+ *  relative pose from the absolute poses, costs about as much as the lookup.
+ */
+template <typename Pose>
+class RelativePoseCache {
+  public:
+    /** \var DEFAULT_NB_SHARDS
+     *  \brief Default number of shards
+     */
+    static const size_t DEFAULT_NB_SHARDS = 64;
+
+    /**
+     * \brief Constructor
+     *
+     * @param nb_shards Number of independently locked parts of the cache
+     */
+    explicit RelativePoseCache(const size_t& nb_shards = DEFAULT_NB_SHARDS): nb_hits_(0), nb_misses_(0) {
+        shards_.reserve(std::max<size_t>(1, nb_shards));
+        for (size_t shard = 0; shard < std::max<size_t>(1, nb_shards); shard++) {
+            shards_.emplace_back(new Shard());
+        }
+    }
+
+    /**
+     * \brief Move constructor, must not be called during queries
+     *
+     * @param other Cache whose relative poses and counters are taken
+     */
+    RelativePoseCache(RelativePoseCache&& other): shards_(std::move(other.shards_)),
+        nb_hits_(other.getNbHits()), nb_misses_(other.getNbMisses()) {}
+
+    /**
+     * \brief Relative pose between two poses of a trajectory, computed at the first query
+     *
+     * Can be called by several threads at the same time. Two threads querying a new key at the
+     * same time may both compute it, the first result is kept.
+     *
+     * @param robot Index of the robot of the trajectory
+     * @param id1 ID of the first pose
+     * @param id2 ID of the second pose
+     * @param compute_relative_pose Function computing the relative pose on a miss, void(Pose&)
+     * @param result Relative pose from id1 to id2
+     */
+    template <typename Compute>
+    void get(const int& robot, const size_t& id1, const size_t& id2, Compute compute_relative_pose, Pose& result) {
+        const Key key{robot, id1, id2};
+        Shard& shard = *shards_[KeyHash()(key) % shards_.size()];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            const auto it = shard.poses.find(key);
+            if (it != shard.poses.end()) {
+                result = it->second;
+                nb_hits_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        nb_misses_.fetch_add(1, std::memory_order_relaxed);
+        compute_relative_pose(result);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.poses.emplace(key, result);
+    }
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of queries answered from the cache
+     */
+    size_t getNbHits() const {
+        return nb_hits_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of queries that computed the relative pose
+     */
+    size_t getNbMisses() const {
+        return nb_misses_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Number of cached relative poses, must not be called during queries
+     *
+     * @returns the number of distinct keys queried
+     */
+    size_t size() const {
+        size_t result = 0;
+        for (const auto& shard: shards_) {
+            result += shard->poses.size();
+        }
+        return result;
+    }
+
+    /**
+     * \brief Empties the cache and resets the counters, must not be called during queries
+     */
+    void clear() {
+        for (auto& shard: shards_) {
+            shard->poses.clear();
+        }
+        nb_hits_ = 0;
+        nb_misses_ = 0;
+    }
+
+  private:
+    /** \struct Key
+     *  \brief Robot and pose IDs of a relative pose
+     */
+    struct Key {
+        int robot;
+        size_t id1, id2;
+
+        bool operator==(const Key& other) const {
+            return robot == other.robot && id1 == other.id1 && id2 == other.id2;
+        }
+    };
+
+    /** \struct KeyHash
+     *  \brief Mix of the fields of a key, its low bits select the shard
+     */
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t hash = (uint64_t(key.id1) * 0x9E3779B97F4A7C15ULL) ^ (uint64_t(key.id2) + 0x632BE59BD9B4E019ULL + uint64_t(key.robot));
+            hash ^= hash >> 29;
+            hash *= 0xBF58476D1CE4E5B9ULL;
+            return hash ^ (hash >> 32);
+        }
+    };
+
+    /** \struct Shard
+     *  \brief Part of the cache protected by its own mutex
+     */
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<Key, Pose, KeyHash, std::equal_to<Key>, Eigen::aligned_allocator<std::pair<const Key, Pose>>> poses;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;///< Shards, allocated separately since the mutexes cannot move
+    std::atomic<size_t> nb_hits_;///< Number of queries answered from the cache
+    std::atomic<size_t> nb_misses_;///< Number of queries that computed the relative pose
+};
+
+template <typename Pose>
+const size_t RelativePoseCache<Pose>::DEFAULT_NB_SHARDS;
+
+}
+
+#endif
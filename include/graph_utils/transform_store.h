@@ -0,0 +1,184 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef GRAPH_UTILS_TRANSFORM_STORE_H
+#define GRAPH_UTILS_TRANSFORM_STORE_H
+
+#include "geometry_msgs/PoseWithCovariance.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace graph_utils {
+
+struct Transform;
+
+/** \class TransformStore
+ *  \brief Contiguous structure-of-arrays storage of transformations.
+ *
+ *  The transforms are kept in insertion order. Each field is stored in its own array and the
+ *  covariance is stored as the packed upper triangle (21 values) of the 6x6 matrix.
+ *  An open addressing hash table indexes the transforms by their pair of pose IDs.
+ *
+ *  Iterating over the indexes visits the transforms in insertion order, which is the order of the
+ *  edges in the parsed file, and not in increasing (i, j) order as the former std::map did. The
+ *  measurements handed to SE-Sync by GlobalMapSolver::fillMeasurements and the records of the
+ *  binary pose graph files follow this order.
+ *
+ *  The hash table stores 32-bit indexes, so a store holds at most MAX_SIZE transforms.
+ */
+class TransformStore {
+  public:
+    /** \var NOT_FOUND
+     *  \brief Index returned by find when there is no transform between the poses
+     */
+    static const size_t NOT_FOUND;
+
+    /** \var NB_COVARIANCE_VALUES
+     *  \brief Number of values of a packed covariance
+     */
+    static const size_t NB_COVARIANCE_VALUES = 21;
+
+    /** \var MAX_SIZE
+     *  \brief Maximum number of transforms, the largest 32-bit index marks the empty slots of the hash table
+     */
+    static const size_t MAX_SIZE;
+
+    /**
+     * \brief Constructor
+     */
+    TransformStore();
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of transforms
+     */
+    size_t size() const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns true if there is no transform
+     */
+    bool empty() const;
+
+    /**
+     * \brief Preallocates the storage
+     *
+     * @param capacity Expected number of transforms, at most MAX_SIZE
+     */
+    void reserve(const size_t& capacity);
+
+    /**
+     * \brief Removes all the transforms
+     */
+    void clear();
+
+    /**
+     * \brief Adds a transform, unless there is already one between the same poses
+     *
+     * Aborts if the store already holds MAX_SIZE transforms.
+     *
+     * @param transform Transform to add
+     * @returns true if the transform was added
+     */
+    bool insert(const Transform& transform);
+
+    /**
+     * \brief Finds the transform between two poses
+     *
+     * @param i ID of the first pose
+     * @param j ID of the second pose
+     * @returns the index of the transform, NOT_FOUND if there is none
+     */
+    size_t find(const size_t& i, const size_t& j) const;
+
+    /**
+     * \brief Finds the transform between two poses
+     *
+     * @param ids IDs of the poses
+     * @returns the index of the transform, NOT_FOUND if there is none
+     */
+    size_t find(const std::pair<size_t, size_t>& ids) const;
+
+    /**
+     * \brief Materializes a transform
+     *
+     * @param index Index of the transform
+     * @returns the transform
+     */
+    Transform at(const size_t& index) const;
+
+    /**
+     * \brief Materializes the pose with covariance of a transform
+     *
+     * @param index Index of the transform
+     * @returns the pose with covariance
+     */
+    geometry_msgs::PoseWithCovariance getPose(const size_t& index) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @param index Index of the transform
+     * @returns the ID of the first pose
+     */
+    const size_t& getI(const size_t& index) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @param index Index of the transform
+     * @returns the ID of the second pose
+     */
+    const size_t& getJ(const size_t& index) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @param index Index of the transform
+     * @returns true if the transform is a loop closure
+     */
+    bool isLoopClosure(const size_t& index) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @param index Index of the transform
+     * @returns pointer to the pose (x y z qx qy qz qw)
+     */
+    const double* getPoseData(const size_t& index) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @param index Index of the transform
+     * @returns pointer to the packed upper triangle of the covariance
+     */
+    const double* getCovarianceData(const size_t& index) const;
+
+    /**
+     * \brief Accessor
+     *
+     * @returns the number of bytes allocated by the store
+     */
+    size_t getMemoryUsage() const;
+
+  private:
+    /** Slot of the hash table where the pose IDs are, or should be inserted */
+    size_t findSlot(const size_t& i, const size_t& j) const;
+
+    /** Doubles the size of the hash table and reinserts the transforms */
+    void growIndex();
+
+    std::vector<size_t> i_, j_; ///< IDs of the poses.
+    std::vector<uint8_t> is_loop_closure_; ///< Loop closure flags.
+    std::vector<double> poses_; ///< Poses, 7 values per transform.
+    std::vector<double> covariances_; ///< Packed covariances, 21 values per transform.
+    std::vector<uint32_t> index_; ///< Open addressing hash table of transform indexes.
+};
+
+}
+
+#endif
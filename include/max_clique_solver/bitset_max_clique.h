@@ -0,0 +1,110 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef BITSET_MAX_CLIQUE_H
+#define BITSET_MAX_CLIQUE_H
+
+#include "graphIO.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace max_clique_solver {
+
+    /** \class BitsetMaxClique
+     * \brief Exact branch and bound search of the maximum clique on bitsets, with coloring bounds (BBMC of San Segundo et al.)
+     *
+     * The vertices are renumbered in a degeneracy order : the vertex of minimum degree is removed repeatedly
+     * and placed last, so the dense core of the graph comes first. The adjacency is a bitset per vertex in that
+     * order, and the candidates of a branch are the intersection of the candidates with the adjacency of the
+     * branching vertex, 64 vertices at a time. At each branch, the candidates are colored greedily, each color
+     * class being an independent set : the clique cannot gain more vertices than the number of colors, so the
+     * candidates are taken from the last color to the first one and the search stops as soon as the colors of
+     * the remaining candidates cannot beat the best clique. Unlike the pruning rules of FMC, which only use the
+     * degrees, this bound stays tight on the dense graphs of loop closures with many inliers.
+     *
+     * The adjacency takes n^2 / 8 bytes, so this search is meant for consistency graphs, not massive sparse graphs.
+     */
+    class BitsetMaxClique {
+      public:
+        /**
+         * \brief Constructor, orders the vertices and builds the adjacency bitsets
+         *
+         * @param gio Graph, which is not referenced after the construction
+         */
+        explicit BitsetMaxClique(FMC::CGraphIO& gio);
+
+        /**
+         * \brief Search of the maximum clique
+         *
+         * @param lower_bound Only the cliques larger than lower_bound are searched
+         * @param max_clique Vertices of the maximum clique in increasing order, empty if there is no clique larger than lower_bound
+         * @returns the size of the maximum clique, lower_bound if there is no larger clique
+         */
+        int findMaxClique(const int& lower_bound, std::vector<int>& max_clique);
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the number of branches expanded by the last search
+         */
+        size_t getNbExpandedNodes() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the degeneracy of the graph plus one, an upper bound of the size of the maximum clique
+         */
+        int getUpperBound() const;
+
+      private:
+        /**
+         * \brief Renumbers the vertices in degeneracy order, with the bucket algorithm of Batagelj and Zaversnik
+         */
+        void orderVertices(const std::vector<int>& vertices, const std::vector<int>& edges);
+
+        /**
+         * \brief Recursive expansion of the current clique with the candidates of a depth
+         *
+         * @param depth Index of the buffers holding the candidates
+         */
+        void expand(const size_t& depth);
+
+        /**
+         * \brief Greedy coloring of the candidates of a depth, in the order of the vertices
+         *
+         * Only the candidates whose color can still lead to a clique larger than the best one are listed.
+         *
+         * @param depth Index of the buffers holding the candidates, the colored candidates and their colors
+         */
+        void colorCandidates(const size_t& depth);
+
+        size_t nb_vertices_;///< Number of vertices
+        size_t nb_words_;///< Number of 64-bit words of a bitset
+        std::vector<int> original_vertices_;///< Vertex of the graph of each vertex in degeneracy order
+        std::vector<uint64_t> adjacency_;///< Bitset of the neighbors of each vertex, nb_words_ words per vertex
+        int degeneracy_;///< Largest minimum degree of the subgraphs removed in degeneracy order
+
+        std::vector<std::vector<uint64_t>> candidates_;///< Candidates of each depth
+        std::vector<std::vector<int>> colored_vertices_;///< Candidates of each depth that can improve the best clique, by increasing color
+        std::vector<std::vector<int>> colors_;///< Color of each of these candidates
+        std::vector<uint64_t> uncolored_, color_class_;///< Buffers of the coloring
+        std::vector<int> clique_;///< Current clique
+        std::vector<int> max_clique_;///< Best clique found
+        int max_clique_size_;///< Size of the best clique found, or lower bound
+        size_t nb_expanded_nodes_;///< Number of branches expanded
+    };
+
+    /**
+     * \brief Maximum clique with BitsetMaxClique, with the call signature of FMC::maxClique
+     *
+     * @param gio Graph
+     * @param l_bound Only the cliques larger than l_bound are searched
+     * @param max_clique_data Vertices of the maximum clique, empty if there is no clique larger than l_bound
+     * @returns the size of the maximum clique, l_bound if there is no larger clique
+     */
+    int maxCliqueBitset(FMC::CGraphIO& gio, int l_bound, std::vector<int>& max_clique_data);
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef FMC_GRAPH_H
+#define FMC_GRAPH_H
+
+#include "graph_utils/consistency_graph.h"
+#include "graph_utils/packed_consistency_matrix.h"
+#include "graphIO.h"
+
+namespace max_clique_solver {
+
+    /**
+     * \brief Loads the consistency graph in the graph of the Fast Max-Cliquer, without going through a .mtx file
+     *
+     * The CSR arrays are the ones that CGraphIO::readGraph builds from the file written by
+     * graph_utils::printConsistencyGraph : the neighbors of each vertex in increasing order.
+     *
+     * @param consistency_graph Consistency graph
+     * @param gio Graph of the maximum clique solver, replaced
+     */
+    void loadConsistencyGraph(const graph_utils::ConsistencyGraph& consistency_graph, FMC::CGraphIO& gio);
+
+    /**
+     * \brief Loads the packed consistency matrix in the graph of the Fast Max-Cliquer, without going through a .mtx file
+     *
+     * @param consistency_matrix Strict upper triangle of the consistency matrix
+     * @param gio Graph of the maximum clique solver, replaced
+     */
+    void loadConsistencyGraph(const graph_utils::PackedConsistencyMatrix& consistency_matrix, FMC::CGraphIO& gio);
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef LAZY_MAX_CLIQUE_H
+#define LAZY_MAX_CLIQUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/** \namespace max_clique_solver
+ *  \brief This namespace encapsulates the searches of the maximum clique of the consistency graph.
+ */
+namespace max_clique_solver {
+
+    /** \class LazyMaxClique
+     * \brief Exact branch and bound search of the maximum clique, which queries the edges on demand
+     *
+     * Russian dolls search of Ostergard : the vertices are added from the last one to the first one, and
+     * the size of the maximum clique of the vertices from v to the last one is recorded for each vertex v,
+     * which bounds the branches without querying any edge. The candidate set of a branch is built by
+     * querying the adjacency of the branching vertex with the next candidates only, and the construction
+     * stops as soon as the branch cannot beat the best clique. So the pairs outside of the candidate sets,
+     * and the pairs of the branches pruned by the bounds, are never queried.
+     */
+    class LazyMaxClique {
+      public:
+        /** \typedef AdjacencyOracle
+         *  \brief Adjacency of two vertices, e.g. pairwise_consistency::ConsistencyOracle::isConsistent
+         */
+        typedef std::function<bool(const size_t&, const size_t&)> AdjacencyOracle;
+
+        /**
+         * \brief Constructor
+         *
+         * @param nb_vertices Number of vertices
+         * @param is_adjacent Adjacency of two vertices, queried on demand
+         */
+        LazyMaxClique(const size_t& nb_vertices, const AdjacencyOracle& is_adjacent);
+
+        /**
+         * \brief Search of the maximum clique
+         *
+         * @param lower_bound Only the cliques larger than lower_bound are searched
+         * @param max_clique Vertices of the maximum clique, empty if there is no clique larger than lower_bound
+         * @returns the size of the maximum clique, lower_bound if there is no larger clique
+         */
+        size_t findMaxClique(const size_t& lower_bound, std::vector<uint32_t>& max_clique);
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the number of branches expanded by the last search
+         */
+        size_t getNbExpandedNodes() const;
+
+      private:
+        /**
+         * \brief Recursive expansion of the current clique with the candidates
+         *
+         * @param candidates Vertices adjacent to all the vertices of the current clique, in increasing order
+         * @returns true if a clique larger than the best one was found
+         */
+        bool expand(const std::vector<uint32_t>& candidates);
+
+        /**
+         * \brief Candidates of the branch of a vertex : the next candidates adjacent to it
+         *
+         * @param vertex Branching vertex
+         * @param begin First of the next candidates
+         * @param end End of the candidates
+         * @param new_candidates Candidates of the branch
+         * @returns false if the branch cannot beat the best clique, in which case the construction is stopped
+         */
+        bool buildCandidates(const uint32_t& vertex, const uint32_t* begin, const uint32_t* end, std::vector<uint32_t>& new_candidates);
+
+        size_t nb_vertices_;///< Number of vertices
+        AdjacencyOracle is_adjacent_;///< Adjacency of two vertices
+        std::vector<uint32_t> clique_;///< Current clique
+        std::vector<uint32_t> max_clique_;///< Best clique found
+        size_t max_clique_size_;///< Size of the best clique found, or lower bound
+        std::vector<size_t> suffix_bounds_;///< Size of the maximum clique of the vertices from v to the last one, for each vertex v
+        size_t nb_expanded_nodes_;///< Number of branches expanded
+    };
+
+}
+
+#endif
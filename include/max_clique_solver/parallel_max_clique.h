@@ -0,0 +1,191 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef PARALLEL_MAX_CLIQUE_H
+#define PARALLEL_MAX_CLIQUE_H
+
+#include "graphIO.h"
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace max_clique_solver {
+
+    /** \class ParallelMaxClique
+     * \brief Multi-threaded exact search of the maximum clique of a graph of the Fast Max-Cliquer
+     *
+     * Branch and bound of FMC::maxClique : the root vertices are taken from the last one to the first one,
+     * with their neighbors of lower index as candidates, and each branch is bounded by the size of the best
+     * clique. The root vertices are distributed over the deques of the threads, which take their own tasks
+     * from the back and steal the tasks of the others from the front. A thread expanding a branch while
+     * another one is idle hands half of its remaining candidates over as a new task, so deep subtrees are
+     * split as well. The size of the best clique is shared by all the threads through an atomic bound.
+     *
+     * The search returns the maximum clique that FMC::maxClique returns : of all the maximum cliques, the
+     * first one in its search order, i.e. the largest in lexicographic order of the vertices in decreasing
+     * order. So the branches that can only reach the size of the best clique are still expanded when they
+     * can lead to a clique coming earlier in that order.
+     */
+    class ParallelMaxClique {
+      public:
+        /** \var MAX_SPLIT_DEPTH
+         *  \brief Depth of the deepest branches that can be split, the deeper ones are too small
+         */
+        static const size_t MAX_SPLIT_DEPTH = 8;
+
+        /** \var MIN_SPLIT_CANDIDATES
+         *  \brief Minimum number of remaining candidates of a branch for it to be split
+         */
+        static const size_t MIN_SPLIT_CANDIDATES = 8;
+
+        /**
+         * \brief Constructor
+         *
+         * @param gio Graph, its arrays must not change during the searches
+         * @param nb_threads Number of threads (0 to use all the hardware threads)
+         */
+        ParallelMaxClique(FMC::CGraphIO& gio, const size_t& nb_threads);
+
+        /**
+         * \brief Search of the maximum clique, the same as FMC::maxClique
+         *
+         * @param lower_bound Only the cliques larger than lower_bound are searched
+         * @param max_clique Vertices of the maximum clique in increasing order, empty if there is no clique larger than lower_bound
+         * @returns the size of the maximum clique, lower_bound if there is no larger clique
+         */
+        int findMaxClique(const int& lower_bound, std::vector<int>& max_clique);
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the number of branches expanded by the last search, by all the threads
+         */
+        size_t getNbExpandedNodes() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the number of tasks that the threads took from the deque of another thread during the last search
+         */
+        size_t getNbStolenTasks() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the number of tasks created by splitting a branch during the last search
+         */
+        size_t getNbSplitTasks() const;
+
+      private:
+        /** \struct Task
+         *  \brief Branch to expand : a clique and the candidates that can extend it
+         */
+        struct Task {
+            std::vector<int> clique;///< Vertices of the clique in decreasing order
+            std::vector<int> candidates;///< Vertices adjacent to all the vertices of the clique, smaller than them, in increasing order
+            bool is_root;///< If true, the clique is a root vertex whose candidates are not built yet
+        };
+
+        /** \struct Best
+         *  \brief Best clique found, or lower bound
+         */
+        struct Best {
+            int size;///< Size of the best clique, or lower bound
+            std::vector<int> clique;///< Vertices of the best clique in decreasing order, empty if no clique is larger than the lower bound
+        };
+
+        /** \struct Worker
+         *  \brief Deque of the tasks of a thread, and its buffers
+         */
+        struct Worker {
+            std::mutex mutex;///< Protects the deque, taken by the thread and by the thieves
+            std::deque<Task> tasks;///< Tasks, taken from the back by the thread and from the front by the thieves
+            std::vector<int> clique;///< Clique of the branch being expanded
+            std::vector<std::vector<int>> candidates;///< Candidates of the branch being expanded, for each depth
+            std::vector<char> is_neighbor;///< Neighbors of the branching vertex, cleared after each branch
+            Best best;///< Copy of the best clique, refreshed when best_version_ changes
+            size_t best_version;///< Version of the copy of the best clique
+            size_t nb_expanded_nodes;///< Number of branches expanded by the thread
+            size_t nb_stolen_tasks;///< Number of tasks stolen by the thread
+            size_t nb_split_tasks;///< Number of tasks created by the thread
+        };
+
+        /**
+         * \brief Loop of a thread, until no task remains
+         */
+        void work(const size_t& worker_index);
+
+        /**
+         * \brief Takes the last task of the thread, or steals the first task of another thread
+         *
+         * @returns false if all the deques are empty
+         */
+        bool takeTask(const size_t& worker_index, Task& task);
+
+        /**
+         * \brief Builds the candidates of a root task, then expands it
+         */
+        void runTask(Worker& worker, Task& task);
+
+        /**
+         * \brief Expansion of the clique of the worker with candidates, branching on the last candidate first
+         *
+         * @param depth Index of the buffer of candidates of the worker holding the candidates
+         */
+        void expand(Worker& worker, const size_t& depth);
+
+        /**
+         * \brief Candidates adjacent to a vertex that can be part of a clique as large as the best one
+         *
+         * @param vertex Branching vertex
+         * @param candidates Candidates, of which the first nb_candidates are kept if adjacent to the vertex
+         * @param nb_candidates Number of candidates considered
+         * @param new_candidates Adjacent candidates, in the same order
+         */
+        void intersect(Worker& worker, const int& vertex, const std::vector<int>& candidates, const size_t& nb_candidates,
+                       std::vector<int>& new_candidates);
+
+        /**
+         * \brief Bound of a branch
+         *
+         * @param next Vertex added to the clique of the worker by the branch
+         * @param max_size Size of the largest clique that the branch can reach
+         * @returns true if the branch can lead to a clique larger than the best one, or as large and earlier in the search order
+         */
+        bool canImprove(Worker& worker, const int& next, const size_t& max_size);
+
+        /**
+         * \brief Records the clique of the worker if it is better than the best clique
+         */
+        void submitClique(Worker& worker);
+
+        /**
+         * \brief Refreshes the copy of the best clique of the worker
+         */
+        void refreshBest(Worker& worker);
+
+        /**
+         * \brief Degree of a vertex
+         */
+        int getDegree(const int& vertex) const;
+
+        const std::vector<int>& vertices_;///< Offsets of the neighbors of each vertex in edges_
+        const std::vector<int>& edges_;///< Neighbors of the vertices
+        size_t nb_threads_;///< Number of threads
+        std::vector<std::unique_ptr<Worker>> workers_;///< Workers, allocated separately since the mutexes cannot move
+
+        std::atomic<int> best_size_;///< Size of the best clique, read without lock to bound the branches
+        std::atomic<size_t> best_version_;///< Incremented with each new best clique
+        std::mutex best_mutex_;///< Protects best_
+        Best best_;///< Best clique
+
+        std::atomic<size_t> nb_pending_tasks_;///< Tasks in the deques or being run
+        std::atomic<size_t> nb_idle_workers_;///< Threads looking for a task
+    };
+
+}
+
+#endif
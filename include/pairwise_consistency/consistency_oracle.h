@@ -0,0 +1,82 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#ifndef CONSISTENCY_ORACLE_H
+#define CONSISTENCY_ORACLE_H
+
+#include "pairwise_consistency/pairwise_consistency.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace pairwise_consistency {
+
+    /** \class ConsistencyOracle
+     * \brief Memoizing consistency test of the pairs of loop closures, evaluated on demand
+     *
+     * A search of the maximum clique only needs the pairs of its candidate sets. Instead of computing the
+     * whole consistency matrix beforehand, the search queries the oracle, which evaluates a pair the first
+     * time it is queried and caches the result. The cache is a bitmap with two bits per pair (evaluated,
+     * consistent), set by a single atomic operation, so that the oracle can be queried by several threads.
+     */
+    class ConsistencyOracle {
+      public:
+        /**
+         * \brief Constructor
+         *
+         * @param pairwise_consistency Consistency test of the loop closures, must outlive the oracle
+         */
+        explicit ConsistencyOracle(const PairwiseConsistency& pairwise_consistency);
+
+        /**
+         * \brief Consistency of a pair of loop closures, evaluated at the first query
+         *
+         * Can be called by several threads at the same time. Two threads querying a new pair at the
+         * same time may both evaluate it.
+         *
+         * @param u Index of the first loop closure
+         * @param v Index of the second loop closure
+         * @returns true if the loop closures are consistent, false if u == v
+         */
+        bool isConsistent(const size_t& u, const size_t& v);
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the number of loop closures
+         */
+        size_t getNbVertices() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the number of queries
+         */
+        size_t getNbQueries() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the number of evaluations of pairs, at most the number of distinct pairs queried
+         * unless several threads evaluated the same pair
+         */
+        size_t getNbEvaluations() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the number of bytes allocated by the cache
+         */
+        size_t getMemoryUsage() const;
+
+      private:
+        const PairwiseConsistency& pairwise_consistency_;///< Consistency test
+        size_t nb_vertices_;///< Number of loop closures
+        std::vector<uint64_t> states_;///< Strict upper triangle, two bits per pair : evaluated, consistent
+        std::atomic<size_t> nb_queries_;///< Number of queries
+        std::atomic<size_t> nb_evaluations_;///< Number of evaluations
+    };
+
+}
+
+#endif
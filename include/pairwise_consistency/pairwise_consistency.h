@@ -4,20 +4,129 @@
 #define PAIRWISE_CONSISTENCY_H
 
 #include "graph_utils/graph_utils_functions.h"
+#include "graph_utils/pose_algebra.h"
+#include "graph_utils/consistency_distances.h"
+#include "graph_utils/consistency_graph.h"
+#include "graph_utils/packed_consistency_matrix.h"
+#include "graph_utils/odometry_tree.h"
+#include "graph_utils/relative_pose_cache.h"
 #include "geometry_msgs/PoseWithCovariance.h"
 
 #include <eigen3/Eigen/Geometry>
+#include <eigen3/Eigen/StdVector>
+#include <vector>
 
 /** \namespace pairwise_consistency
  *  \brief This namespace encapsulates the tools for the pairwise consistency computation.
  */
 namespace pairwise_consistency {
 
+    /** \struct LoopClosureEntry
+     * \brief Data of a loop closure (i, k) that does not depend on the other loop closure of a pair
+     */
+    struct LoopClosureEntry {
+        static const uint8_t ROBOT1_TO_ROBOT2 = 1;///< Pose i is on the trajectory of robot 1 and pose k on the trajectory of robot 2
+        static const uint8_t ROBOT2_TO_ROBOT1 = 2;///< Pose i is on the trajectory of robot 2 and pose k on the trajectory of robot 1
+
+        uint8_t orientations;///< Bitmask of the orientations of the loop closure, 0 if it is not inter-robot
+        size_t first_indexes[2];///< Index of pose i in the trajectories of robot 1 and robot 2 (valid if the orientation allows it)
+        size_t second_indexes[2];///< Index of pose k in the trajectories of robot 1 and robot 2 (valid if the orientation allows it)
+    };
+
+    /** \struct ConsistencyPoses
+     * \brief Poses involved in the consistency test, converted once to the fixed-size pose type
+     * of the dimension of the measurements (graph_utils::PoseSE2 or graph_utils::PoseSE3)
+     *
+     * Together with the loop closure entries, it is the loop closure table of the consistency test :
+     * everything that depends on a single loop closure is resolved in O(m), so that a pair of
+     * loop closures is evaluated by indexing arrays only.
+     *
+     * The consistency loop of the pair (u, v) = ((i, k), (j, l)) is abZik^-1 + aXi^-1 + aXj + abZjl + bXl^-1 + bXk.
+     * Its first two factors only depend on the row u and its next three factors only depend on the column v,
+     * so they are composed once per loop closure : the pair costs two compositions, with the last factor bXk.
+     */
+    template <typename Pose>
+    struct ConsistencyPoses {
+        typedef std::vector<Pose, Eigen::aligned_allocator<Pose>> Poses;
+        typedef typename graph_utils::PoseTraits<Pose>::Isometry Isometry;
+
+        /** \struct LoopTransformations
+         * \brief Means of the row and column terms of a loop closure, for the first stage of the evaluation
+         */
+        struct LoopTransformations {
+            Isometry row;///< abZik^-1 + aXi^-1
+            typename Isometry::VectorType row_origin;///< Position of abZik^-1
+            typename Isometry::VectorType second_position;///< Position of bXk
+            Isometry column;///< aXj + abZjl + bXl^-1
+            typename Isometry::VectorType column_origins[2];///< Positions of aXj and aXj + abZjl
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        };
+
+        Poses trajectories[2];///< Trajectory poses of robot 1 and robot 2, indexed by id - start_id
+        std::vector<LoopClosureEntry> loop_closure_entries;///< Orientation and trajectory indexes, in the same order as the loop closures
+        Poses loop_closures;///< Measurements of the loop closures, in the same order as the loop closures
+        Poses row_terms[2];///< abZik^-1 + aXi^-1 of the loop closures, for robot A = robot 1 and robot 2 (valid if the orientation allows it)
+        Poses column_terms[2];///< aXj + abZjl + bXl^-1 of the loop closures, for robot A = robot 1 and robot 2 (valid if the orientation allows it)
+        std::vector<LoopTransformations, Eigen::aligned_allocator<LoopTransformations>> loop_transformations[2];///< Means of the terms, in the same way
+        graph_utils::OdometryTree<Pose> odometries[2];///< Odometry of robot 1 and robot 2, built if the relative poses are composed from the odometry
+        mutable graph_utils::RelativePoseCache<Pose> relative_poses;///< Relative poses composed from the odometry in 3D, at most one per pair of poses of a trajectory
+    };
+
+    /** \struct StandardDeviations
+     * \brief Square roots of the traces of the translation and angle blocks of a covariance
+     */
+    struct StandardDeviations {
+        double translation;///< Square root of the trace of the covariance of the translation
+        double angles;///< Square root of the trace of the covariance of the angles
+    };
+
+    /** \struct RejectionBounds
+     * \brief Deviations of the trajectory poses and of the loop closures, used by the early rejection to bound
+     * the covariance of the position of a consistency loop without propagating the covariances
+     */
+    struct RejectionBounds {
+        std::vector<StandardDeviations> deviations[2];///< Deviations of the trajectory poses of robot 1 and robot 2, indexed by id - start_id
+        std::vector<StandardDeviations> loop_closure_deviations;///< Deviations of the loop closures
+        double angle_factor = 1;///< Bound of the norm of the Jacobian of a position with respect to the angles, per unit of lever arm
+    };
+
+    /** \struct ConsistencyStatistics
+     * \brief Counts of the pairs of loop closures of the last computation of the consistency
+     */
+    struct ConsistencyStatistics {
+        size_t nb_pairs = 0;///< Pairs of loop closures
+        size_t nb_interrobot_pairs = 0;///< Pairs of loop closures forming an inter-robot consistency loop
+        size_t nb_early_rejected_pairs = 0;///< Pairs rejected by the bound of the residual without the covariances
+        size_t nb_evaluated_pairs = 0;///< Pairs whose squared Mahalanobis distance was computed
+        size_t nb_consistent_pairs = 0;///< Pairs under the chi-squared threshold
+
+        ConsistencyStatistics& operator+=(const ConsistencyStatistics& other) {
+            nb_pairs += other.nb_pairs;
+            nb_interrobot_pairs += other.nb_interrobot_pairs;
+            nb_early_rejected_pairs += other.nb_early_rejected_pairs;
+            nb_evaluated_pairs += other.nb_evaluated_pairs;
+            nb_consistent_pairs += other.nb_consistent_pairs;
+            return *this;
+        }
+    };
+
     /** \class PairwiseConsistency
      * \brief Class for the computation of the pairwise consistency of loop closure edges
+     *
+     * The consistency test is templated on the pose type and the dimension of the measurements
+     * is dispatched outside of the O(m^2) loop : the poses are converted once in the constructor,
+     * then 2D measurements are processed with 3x3 kernels and 3D measurements with 6x6 kernels.
+     * The poses are composed with MRPT, or with the closed-form Jacobians of graph_utils/pose_algebra.h
+     * when built with USE_NATIVE_POSE_ALGEBRA. In 2D, the residual is (x, y, sin(yaw / 2)) with the 3x3
+     * covariance of (x, y, yaw) : the 6x6 covariance of planar poses is singular.
      */ 
     class PairwiseConsistency {
       public:
+        /** \var TILE_SIZE
+         * \brief Number of rows and columns of the tiles of the consistency matrix distributed to the threads
+         */
+        static const size_t TILE_SIZE = 64;
+
         /**
          * \brief Constructor
          *
@@ -28,6 +137,13 @@ namespace pairwise_consistency {
          * @param trajectory_robot1 Precomputed trajectory of robot 1
          * @param trajectory_robot2 Precomputed trajectory of robot 2
          * @param nb_degree_freedom Number of degree of freedom of the robots measurements.
+         * @param nb_threads Number of threads used to compute the consistency matrix (0 to use all the hardware threads)
+         * @param use_early_rejection If true, the consistency loop is first composed without the covariances, and the
+         * covariances are propagated only if its residual is not provably above the threshold
+         * @param use_odometry_relative_poses If true, the relative poses aXij and bXlk of a pair are composed from the odometry
+         * between the poses, whose covariance is the one of this odometry only, instead of from the absolute poses of the
+         * trajectories, which count twice the uncertainty of their common history. They are queried in O(log n) compositions
+         * from the odometry trees, and memoized in 3D.
          */
         PairwiseConsistency(const graph_utils::Transforms& transforms_robot1,
                             const graph_utils::Transforms& transforms_robot2,
@@ -35,20 +151,93 @@ namespace pairwise_consistency {
                             const graph_utils::LoopClosures& loop_closures,
                             const graph_utils::Trajectory& trajectory_robot1,
                             const graph_utils::Trajectory& trajectory_robot2,
-                            uint8_t nb_degree_freedom):
-                            loop_closures_(loop_closures), transforms_robot1_(transforms_robot1), 
-                            transforms_robot2_(transforms_robot2), transforms_interrobot_(transforms_interrobot),
-                            trajectory_robot1_(trajectory_robot1), trajectory_robot2_(trajectory_robot2),
-                            nb_degree_freedom_(nb_degree_freedom){};
+                            uint8_t nb_degree_freedom,
+                            const size_t& nb_threads = 1,
+                            const bool& use_early_rejection = true,
+                            const bool& use_odometry_relative_poses = false);
 
         /**
          * \brief Computation of the consistency matrix
          *
+         * The upper triangle is split in tiles of TILE_SIZE x TILE_SIZE pairs that the threads
+         * take in turn. The result does not depend on the number of threads.
          *
          * @returns the consistency matrix
          */ 
         Eigen::MatrixXi computeConsistentMeasurementsMatrix();
 
+        /**
+         * \brief Computation of the consistency graph, without the dense matrix
+         *
+         * Each thread appends the consistent pairs of its tiles to its own edge buffer and the
+         * buffers are then gathered in a sparse adjacency, so the memory is proportional to the
+         * number of consistent pairs. The graph does not depend on the number of threads.
+         *
+         * @returns the consistency graph, its vertices are the indexes of the loop closures
+         */
+        graph_utils::ConsistencyGraph computeConsistencyGraph();
+
+        /**
+         * \brief Computation of the consistency matrix, packed in bits
+         *
+         * One bit per pair of loop closures, preferable to the sparse consistency graph when most
+         * of the pairs are consistent. The matrix does not depend on the number of threads.
+         *
+         * @returns the strict upper triangle of the consistency matrix
+         */
+        graph_utils::PackedConsistencyMatrix computePackedConsistencyMatrix();
+
+        /**
+         * \brief Computation of the squared Mahalanobis distances of the pairs of loop closures
+         *
+         * The consistency graph for any threshold up to max_threshold can then be derived without
+         * evaluating the pairs again, e.g. to tune the threshold.
+         *
+         * @param max_threshold Largest threshold on the squared Mahalanobis distance, the pairs above it are not stored
+         * @returns the distances of the pairs below max_threshold
+         */
+        graph_utils::ConsistencyDistances computeConsistencyDistances(const double& max_threshold);
+
+        /**
+         * \brief Evaluation of a single pair of loop closures, without memoization
+         *
+         * Can be called by several threads at the same time.
+         *
+         * @param u Index of the first loop closure
+         * @param v Index of the second loop closure, different from u
+         * @param statistics Counts of the pairs, updated
+         * @returns true if the loop closures are consistent
+         */
+        bool evaluatePair(const size_t& u, const size_t& v, ConsistencyStatistics& statistics) const;
+
+        /**
+         * \brief Threshold on the squared Mahalanobis distance (chi-squared table)
+         *
+         * @returns the threshold used by the consistency graph and matrices
+         */
+        double getChiSquaredThreshold() const;
+
+        /**
+         * \brief Brings the persistent consistency graph up to date with the loop closures
+         *
+         * Only the pairs of which the second loop closure is not yet a vertex of the graph are evaluated:
+         * the first call computes the whole graph, the next ones only the rows of the new loop closures.
+         *
+         * @returns the persistent consistency graph
+         */
+        const graph_utils::DynamicConsistencyGraph& updateConsistencyGraph();
+
+        /**
+         * \brief Adds newly arriving loop closures and appends their edges to the persistent consistency graph
+         *
+         * The k new loop closures are evaluated against the m existing ones and between themselves, O(k m)
+         * instead of O((m + k)^2) for a full computation.
+         *
+         * @param loop_closures New loop closures, between the trajectories of the two robots
+         * @param transforms_interrobot Measurements of the new loop closures
+         */
+        void addLoopClosures(const graph_utils::LoopClosures& loop_closures, const graph_utils::Transforms& transforms_interrobot);
+
         /*
          * Accessors
          */
@@ -80,39 +269,206 @@ namespace pairwise_consistency {
          * @returns map of the inter-robot transforms
          */
         const graph_utils::Transforms& getTransformsInterRobot() const;
+
+        /**
+         * \brief Accessor
+         *
+         * Only the table of the pose type of the measurements (PoseSE2 in 2D, PoseSE3 in 3D) is filled.
+         * @returns loop closure table of the consistency test
+         */
+        template <typename Pose>
+        const ConsistencyPoses<Pose>& getLoopClosureTable() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns counts of the pairs of loop closures of the last computation of the consistency
+         */
+        const ConsistencyStatistics& getStatistics() const;
+
+        /**
+         * \brief Accessor
+         *
+         * @returns the persistent consistency graph, as of the last update
+         */
+        const graph_utils::DynamicConsistencyGraph& getConsistencyGraph() const;
     private:
 
         /**
-         * \brief Computes the consistency loop : aXij + abZjl + bXlk - abZik (see references)
+         * \brief Builds the loop closure table : converts the trajectories and the loop closure measurements
+         * to the pose type, and resolves the orientation and the trajectory indexes of the loop closures
+         */
+        template <typename Pose>
+        void buildLoopClosureTable(ConsistencyPoses<Pose>& poses);
+
+        /**
+         * \brief Appends the loop closures from first_loop_closure to the loop closure table
          *
-         * @param aXij Transformation between poses i and j on robot A trajectory
-         * @param bXlk Transformation between poses l and k on robot B trajectory
-         * @param abZik Transformation between pose i of robot A trajectory and pose k of robot B trajectory
-         * @param abZjl Transformation between pose j of robot A trajectory and pose l of robot B trajectory
-         * @return
+         * @param poses Loop closure table
+         * @param first_loop_closure Index of the first loop closure not yet in the table
          */
-        geometry_msgs::PoseWithCovariance computeConsistencyPose(const geometry_msgs::PoseWithCovariance& aXij, 
-                                                        const geometry_msgs::PoseWithCovariance& bXlk, 
-                                                        const geometry_msgs::PoseWithCovariance& abZik, 
-                                                        const geometry_msgs::PoseWithCovariance& abZjl);
+        template <typename Pose>
+        void extendLoopClosureTable(ConsistencyPoses<Pose>& poses, const size_t& first_loop_closure);
 
         /**
-         * \brief Compute the Mahalanobis Distance of the input pose (result of pose_a-pose_b)
+         * \brief Builds the standard deviations of the trajectories for the early rejection
+         */
+        template <typename Pose>
+        void buildRejectionBounds(const ConsistencyPoses<Pose>& poses);
+
+        /**
+         * \brief Distributes the tiles of the upper triangle of the consistency matrix to the threads
          *
-         * @param transform pose measurement describing the difference between two poses.
-         * @returns Mahalanobis Distance
+         * @param first_column Columns before first_column are skipped, 0 for the whole upper triangle
+         * @param process_tile Function called with (thread index, first row, end row, first column, end column) of each tile,
+         * the thread index is lower than nb_threads_
+         */
+        template <typename TileFunction>
+        void forEachTile(const size_t& first_column, const TileFunction& process_tile) const;
+
+        /**
+         * \brief Squared Mahalanobis distance of the consistency loop of a pair of loop closures
+         *
+         * @param poses Loop closure table
+         * @param u Index of the first loop closure
+         * @param v Index of the second loop closure
+         * @param threshold Threshold on the squared Mahalanobis distance, used by the bounds
+         * @param distance Squared Mahalanobis distance
+         * @param statistics Counts of the pairs, updated
+         * @returns false if the pair of loop closures does not form an inter-robot consistency loop or is pruned
+         */
+        template <typename Pose>
+        bool computePairSquaredDistance(const ConsistencyPoses<Pose>& poses, const size_t& u, const size_t& v,
+                                        const double& threshold, double& distance, ConsistencyStatistics& statistics) const;
+
+        /**
+         * \brief Stage one of the evaluation : lower bound of the squared Mahalanobis distance of the position of the
+         * consistency loop, composed without the covariances
+         *
+         * @param poses Loop closure table
+         * @param robot_a Robot of the poses i and j
+         * @param robot_b Robot of the poses k and l
+         * @param entry_ik Entry of the first loop closure
+         * @param entry_jl Entry of the second loop closure
+         * @param u Index of the first loop closure
+         * @param v Index of the second loop closure
+         * @param threshold Threshold on the squared Mahalanobis distance
+         * @returns true if the lower bound is above the threshold
+         */
+        template <typename Pose>
+        bool isRejectedEarly(const ConsistencyPoses<Pose>& poses, const int& robot_a, const int& robot_b,
+                             const LoopClosureEntry& entry_ik, const LoopClosureEntry& entry_jl,
+                             const size_t& u, const size_t& v, const double& threshold) const;
+
+        /**
+         * \brief Upper bound of the trace of the covariance of the position of the consistency loop
+         *
+         * @param robot_a Robot of the poses i and j
+         * @param robot_b Robot of the poses k and l
+         * @param entry_ik Entry of the first loop closure
+         * @param entry_jl Entry of the second loop closure
+         * @param u Index of the first loop closure
+         * @param v Index of the second loop closure
+         * @param levers Bounds of the lever arms of abZik^-1, aXi^-1, aXj, abZjl, bXl^-1 and bXk
+         * @returns the bound of the trace
+         */
+        double boundPositionCovarianceTrace(const int& robot_a, const int& robot_b, const LoopClosureEntry& entry_ik,
+                                            const LoopClosureEntry& entry_jl, const size_t& u, const size_t& v,
+                                            const double levers[6]) const;
+
+        /**
+         * \brief Evaluates the pairs of loop closures over the tiles and updates the statistics
+         *
+         * @param poses Loop closure table
+         * @param first_column Only the pairs (u, v) with v >= first_column are evaluated
+         * @param threshold Threshold on the squared Mahalanobis distance
+         * @param add_pair Function called with (thread index, u, v, squared Mahalanobis distance) for each pair below
+         * the threshold, u < v
+         */
+        template <typename Pose, typename PairFunction>
+        void forEachConsistentPair(const ConsistencyPoses<Pose>& poses, const size_t& first_column,
+                                   const double& threshold, const PairFunction& add_pair);
+
+        /**
+         * \brief Computation of the consistency matrix with the fixed-size kernels of the pose type
+         *
+         * @param poses Loop closure table
+         * @returns the consistency matrix
+         */
+        template <typename Pose>
+        Eigen::MatrixXi computeConsistencyMatrix(const ConsistencyPoses<Pose>& poses);
+
+        /**
+         * \brief Computation of the consistency graph with the fixed-size kernels of the pose type
+         *
+         * @param poses Loop closure table
+         * @returns the consistency graph
          */
-        double computeSquaredMahalanobisDistance(const geometry_msgs::PoseWithCovariance& transform);
+        template <typename Pose>
+        graph_utils::ConsistencyGraph computeConsistencyGraph(const ConsistencyPoses<Pose>& poses);
 
         /**
-         * \brief This function returns the transform the two specified poses on the desired robot trajectory
+         * \brief Computation of the packed consistency matrix with the fixed-size kernels of the pose type
          *
-         * @param id1 first pose ID
-         * @param id2 second pose ID
-         * @param robot_id robot ID to select to desired trajectory
-         * @return transform (pose measurements) between the two poses
+         * @param poses Loop closure table
+         * @returns the strict upper triangle of the consistency matrix
          */
-        geometry_msgs::PoseWithCovariance composeOnTrajectory(const size_t& id1, const size_t& id2, const size_t& robot_id);
+        template <typename Pose>
+        graph_utils::PackedConsistencyMatrix computePackedConsistencyMatrix(const ConsistencyPoses<Pose>& poses);
+
+        /**
+         * \brief Appends the edges of the loop closures which are not yet vertices to the persistent consistency graph
+         *
+         * @param poses Loop closure table
+         */
+        template <typename Pose>
+        void updateConsistencyGraph(const ConsistencyPoses<Pose>& poses);
+
+        /**
+         * \brief Computation of the squared Mahalanobis distances with the fixed-size kernels of the pose type
+         *
+         * @param poses Loop closure table
+         * @param max_threshold Largest threshold on the squared Mahalanobis distance
+         * @returns the distances of the pairs below max_threshold
+         */
+        template <typename Pose>
+        graph_utils::ConsistencyDistances computeConsistencyDistances(const ConsistencyPoses<Pose>& poses, const double& max_threshold);
+
+        /**
+         * \brief Computes the row and column terms of a loop closure for an orientation, and their means
+         *
+         * @param poses Loop closure table
+         * @param index Index of the loop closure
+         * @param robot_a Robot of the first pose of the loop closure
+         */
+        template <typename Pose>
+        static void computeLoopTerms(ConsistencyPoses<Pose>& poses, const size_t& index, const int& robot_a);
+
+        /**
+         * \brief Relative pose between two poses of a trajectory, composed from the odometry between them
+         *
+         * In 3D the relative poses are memoized in the relative_poses cache of the loop closure table, since the
+         * pairs of loop closures share their poses. In 2D the odometry tree is queried directly.
+         * @param poses Loop closure table
+         * @param robot Robot of the trajectory
+         * @param index1 Index of the first pose in the trajectory
+         * @param index2 Index of the second pose in the trajectory
+         * @param result Relative pose Xindex1^-1 + Xindex2
+         */
+        template <typename Pose>
+        void getOdometryRelativePose(const ConsistencyPoses<Pose>& poses, const int& robot, const size_t& index1,
+                                     const size_t& index2, Pose& result) const;
+
+        /**
+         * \brief Compute the Mahalanobis Distance of the input pose (result of pose_a-pose_b)
+         *
+         * The residual is made of the position and of the vector part of the quaternion,
+         * restricted to x, y and qz in 2D.
+         * @param transform pose measurement describing the difference between two poses.
+         * @returns Mahalanobis Distance
+         */
+        static double computeSquaredMahalanobisDistance(const graph_utils::PoseSE2& transform);
+        static double computeSquaredMahalanobisDistance(const graph_utils::PoseSE3& transform);
 
         graph_utils::LoopClosures loop_closures_;///< loop_closures to consider
 
@@ -121,8 +477,29 @@ namespace pairwise_consistency {
         graph_utils::Trajectory trajectory_robot1_, trajectory_robot2_;///< Trajectory of the robots
 
         uint8_t nb_degree_freedom_;///< Number of degree of freedom of the measurements.
+
+        size_t nb_threads_;///< Number of threads used to compute the consistency matrix.
+
+        bool use_early_rejection_;///< Skip the pairs rejected by the residual of the loop without the covariances.
+
+        bool use_odometry_relative_poses_;///< Compose the relative poses of the pairs from the odometry.
+
+        RejectionBounds rejection_bounds_;///< Deviations used by the early rejection, filled if it is used
+
+        ConsistencyStatistics statistics_;///< Counts of the pairs of the last computation.
+
+        graph_utils::DynamicConsistencyGraph consistency_graph_;///< Persistent consistency graph, extended as the loop closures arrive
+
+        ConsistencyPoses<graph_utils::PoseSE2> poses_se2_;///< Loop closure table, filled if the measurements are 2D
+        ConsistencyPoses<graph_utils::PoseSE3> poses_se3_;///< Loop closure table, filled if the measurements are 3D
     };          
 
+    template <>
+    const ConsistencyPoses<graph_utils::PoseSE2>& PairwiseConsistency::getLoopClosureTable<graph_utils::PoseSE2>() const;
+
+    template <>
+    const ConsistencyPoses<graph_utils::PoseSE3>& PairwiseConsistency::getLoopClosureTable<graph_utils::PoseSE3>() const;
+
 }
 
 #endif
\ No newline at end of file
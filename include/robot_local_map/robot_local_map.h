@@ -13,9 +13,21 @@ namespace robot_local_map {
       public:
         /**
          * \brief Constructor
+         *
+         * A binary pose graph file is mapped once, and its records are copied as with the constructor from the mapping.
          * @param file_name Name of the file containing the robot measurements.
+         * @param nb_threads Number of threads used to parse the file (0 to use all the hardware threads)
          */
-        RobotLocalMap(const std::string & file_name);
+        RobotLocalMap(const std::string & file_name, const size_t& nb_threads = 1);
+
+        /**
+         * \brief Constructor
+         *
+         * The trajectory saved in the file is used if there is one, otherwise it is computed. The records are
+         * copied from the mapping, which is not referenced after the construction.
+         * @param file Memory mapped binary pose graph file
+         */
+        RobotLocalMap(const graph_utils::PoseGraphBinaryFile& file);
 
         /*
          * Accessors
@@ -27,6 +39,12 @@ namespace robot_local_map {
         const graph_utils::Trajectory& getTrajectory() const;
 
       private:
+        /**
+         * \brief Copies the trajectory saved in a binary pose graph file, or computes it if there is none
+         * @param file Memory mapped binary pose graph file
+         */
+        void loadTrajectory(const graph_utils::PoseGraphBinaryFile& file);
+
         graph_utils::Trajectory trajectory_; ///< Local trajectory of the robot.
     };          
 }
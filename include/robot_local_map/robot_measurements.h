@@ -4,6 +4,7 @@
 #define ROBOT_MEASUREMENTS_H
 
 #include "graph_utils/graph_types.h"
+#include "graph_utils/pose_graph_binary.h"
 
 /** \namespace robot_local_map
  *  \brief This namespace encapsulates classes and functions related to the local maps of the individual robots.
@@ -19,9 +20,19 @@ namespace robot_local_map {
       public:
         /**
          * \brief Constructor
-         * @param file_name
+         * @param file_name Name of a .g2o file, or of a binary pose graph file (.pgb)
+         * @param is_only_loop_closures If true, the file is expected to contain only loop closures
+         * @param nb_threads Number of threads used to parse the file (0 to use all the hardware threads)
          */
-        RobotMeasurements(const std::string & file_name, const bool& is_only_loop_closures);
+        RobotMeasurements(const std::string & file_name, const bool& is_only_loop_closures, const size_t& nb_threads = 1);
+
+        /**
+         * \brief Constructor
+         *
+         * The records are copied from the mapping, which is not referenced after the construction.
+         * @param file Memory mapped binary pose graph file
+         */
+        RobotMeasurements(const graph_utils::PoseGraphBinaryFile& file);
 
         /*
          * Accessors
@@ -48,6 +59,25 @@ namespace robot_local_map {
         virtual const uint8_t& getNbDegreeFreedom() const;
 
       protected:
+        /**
+         * \brief Constructor of empty measurements, filled by the derived classes
+         */
+        RobotMeasurements();
+
+        /**
+         * \brief Fills the measurements from a .g2o file
+         * @param file_name Name of the .g2o file
+         * @param is_only_loop_closures If true, the file is expected to contain only loop closures
+         * @param nb_threads Number of threads used to parse the file (0 to use all the hardware threads)
+         */
+        void loadG2oFile(const std::string & file_name, const bool& is_only_loop_closures, const size_t& nb_threads);
+
+        /**
+         * \brief Fills the measurements from a binary pose graph file, the records are copied
+         * @param file Memory mapped binary pose graph file
+         */
+        void loadBinaryFile(const graph_utils::PoseGraphBinaryFile& file);
+
         graph_utils::Transforms transforms_; ///< std::map containing all the local measurements of the robot.
         size_t num_poses_; ///< Number of poses in the map
         graph_utils::LoopClosures loop_closures_; ///< std::vector containing the ID pairs of the loop closures
@@ -1,57 +1,127 @@
 // Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
 
 #include "global_map_solver/global_map_solver.h"
+#include "pairwise_consistency/consistency_oracle.h"
+#include "max_clique_solver/lazy_max_clique.h"
+#include "max_clique_solver/fmc_graph.h"
+#include "max_clique_solver/parallel_max_clique.h"
+#include "max_clique_solver/bitset_max_clique.h"
 #include "findClique.h"
 #include <math.h>
+#include <algorithm>
+#include <iostream>
 
 
 namespace global_map_solver {
 
+namespace {
+
+/** Hands the consistency graph to the maximum clique solver in memory, and exports it if requested */
+template <typename Graph>
+void loadMaxCliqueGraph(const Graph& consistency_graph, const bool& export_consistency_matrix, FMC::CGraphIO& gio) {
+    if (export_consistency_matrix) {
+        graph_utils::printConsistencyGraph(consistency_graph, GlobalMapSolver::CONSISTENCY_MATRIX_FILE_NAME);
+    }
+    max_clique_solver::loadConsistencyGraph(consistency_graph, gio);
+}
+
+/**
+ * Maximum clique of the graph, on bitsets if requested, else by the parallel solver unless a single thread is requested.
+ * The heuristic clique is computed first : the exact search only looks for larger cliques, and it is the answer if there is none.
+ */
+int findMaxClique(FMC::CGraphIO& gio, const size_t& nb_threads, const bool& use_bitset_max_clique, std::vector<int>& max_clique_data) {
+    std::vector<int> heuristic_clique;
+    const int lower_bound = std::max(0, FMC::maxCliqueHeu(gio, heuristic_clique));
+    int max_clique_size;
+    max_clique_data.clear();
+    if (use_bitset_max_clique) {
+        max_clique_size = max_clique_solver::maxCliqueBitset(gio, lower_bound, max_clique_data);
+    } else if (nb_threads == 1) {
+        max_clique_size = FMC::maxClique(gio, lower_bound, max_clique_data);
+    } else {
+        max_clique_solver::ParallelMaxClique search(gio, nb_threads);
+        max_clique_size = search.findMaxClique(lower_bound, max_clique_data);
+    }
+    if (max_clique_data.empty()) {
+        max_clique_data = heuristic_clique;
+    }
+    return max_clique_size;
+}
+
+}
+
 const std::string GlobalMapSolver::CONSISTENCY_MATRIX_FILE_NAME = std::string("results/consistency_matrix.clq.mtx");
 const std::string GlobalMapSolver::CONSISTENCY_LOOP_CLOSURES_FILE_NAME = std::string("results/consistent_loop_closures.txt");
 
 GlobalMapSolver::GlobalMapSolver(const robot_local_map::RobotLocalMap& robot1_local_map,
                 const robot_local_map::RobotLocalMap& robot2_local_map,
-                const robot_local_map::RobotMeasurements& interrobot_measurements): 
+                const robot_local_map::RobotMeasurements& interrobot_measurements,
+                const GlobalMapSolverOptions& options): 
                 pairwise_consistency_(robot1_local_map.getTransforms(), robot2_local_map.getTransforms(), 
                             interrobot_measurements.getTransforms(), interrobot_measurements.getLoopClosures(),
                             robot1_local_map.getTrajectory(), robot2_local_map.getTrajectory(),
-                            robot1_local_map.getNbDegreeFreedom()){}
+                            robot1_local_map.getNbDegreeFreedom(), options.nb_threads,
+                            options.use_early_rejection, options.use_odometry_relative_poses),
+                options_(options){
+    // The lazy search queries the pairs one at a time and never builds the consistency graph
+    if (options_.use_lazy_consistency) {
+        if (options_.nb_threads != 1) {
+            std::cerr << "Lazy consistency : the maximum clique is searched on a single thread, nb_threads is ignored" << std::endl;
+        }
+        if (options_.use_packed_consistency_matrix || options_.export_consistency_matrix) {
+            std::cerr << "Lazy consistency : no consistency graph is built, use_packed_consistency_matrix and "
+                         "export_consistency_matrix are ignored" << std::endl;
+        }
+        if (options_.use_bitset_max_clique) {
+            std::cerr << "Lazy consistency : use_bitset_max_clique is ignored" << std::endl;
+        }
+    }
+}
 
 SESync::measurements_t GlobalMapSolver::fillMeasurements(const std::vector<int>& max_clique_data){
 
     // Preallocate output vector
     SESync::measurements_t measurements;
+    const graph_utils::TransformStore* stores[3] = {&pairwise_consistency_.getTransformsRobot1().transforms,
+                                                   &pairwise_consistency_.getTransformsRobot2().transforms,
+                                                   &pairwise_consistency_.getTransformsInterRobot().transforms};
+    measurements.reserve(stores[0]->size() + stores[1]->size() + stores[2]->size());
 
-    for (auto const& t : pairwise_consistency_.getTransformsRobot1().transforms)
+    for (const auto store : stores)
     {
-        measurements.push_back(graph_utils::convertTransformToRelativePoseMeasurement(t.second));
-    }
-
-    for (auto const& t : pairwise_consistency_.getTransformsRobot2().transforms)
-    {
-        measurements.push_back(graph_utils::convertTransformToRelativePoseMeasurement(t.second));
-    }
-
-    for (auto const& t : pairwise_consistency_.getTransformsInterRobot().transforms)
-    {
-        measurements.push_back(graph_utils::convertTransformToRelativePoseMeasurement(t.second));
+        for (size_t index = 0; index < store->size(); index++)
+        {
+            measurements.push_back(graph_utils::convertTransformToRelativePoseMeasurement(store->at(index)));
+        }
     }
 
     return measurements;
 }
 
 int GlobalMapSolver::solveGlobalMap() {
-    // Compute consistency matrix
-    Eigen::MatrixXi consistency_matrix = pairwise_consistency_.computeConsistentMeasurementsMatrix();
-    graph_utils::printConsistencyGraph(consistency_matrix, CONSISTENCY_MATRIX_FILE_NAME);
-    
-    // Compute maximum clique
-    FMC::CGraphIO gio;
-    gio.readGraph(CONSISTENCY_MATRIX_FILE_NAME);
     int max_clique_size = 0;
     std::vector<int> max_clique_data;
-    max_clique_size = FMC::maxClique(gio, max_clique_size, max_clique_data);
+    if (options_.use_lazy_consistency) {
+        // Compute maximum clique, the consistency of the pairs is evaluated on demand on this thread, from an empty lower bound
+        pairwise_consistency::ConsistencyOracle oracle(pairwise_consistency_);
+        max_clique_solver::LazyMaxClique lazy_max_clique(oracle.getNbVertices(), [&oracle](const size_t& u, const size_t& v) {
+            return oracle.isConsistent(u, v);
+        });
+        std::vector<uint32_t> max_clique;
+        max_clique_size = lazy_max_clique.findMaxClique(0, max_clique);
+        max_clique_data.assign(max_clique.begin(), max_clique.end());
+    } else {
+        // Compute consistency graph
+        FMC::CGraphIO gio;
+        if (options_.use_packed_consistency_matrix) {
+            loadMaxCliqueGraph(pairwise_consistency_.computePackedConsistencyMatrix(), options_.export_consistency_matrix, gio);
+        } else {
+            loadMaxCliqueGraph(pairwise_consistency_.computeConsistencyGraph(), options_.export_consistency_matrix, gio);
+        }
+
+        // Compute maximum clique
+        max_clique_size = findMaxClique(gio, options_.nb_threads, options_.use_bitset_max_clique, max_clique_data);
+    }
 
     // Print results
     graph_utils::printConsistentLoopClosures(pairwise_consistency_.getLoopClosures(), max_clique_data, CONSISTENCY_LOOP_CLOSURES_FILE_NAME);
@@ -73,4 +143,27 @@ int GlobalMapSolver::solveGlobalMap() {
     return max_clique_size;
 }
 
-}
\ No newline at end of file
+std::vector<int> GlobalMapSolver::computeMaxCliqueSizes(const std::vector<double>& thresholds) {
+    std::vector<int> max_clique_sizes;
+    if (thresholds.empty()) {
+        return max_clique_sizes;
+    }
+
+    // Evaluate the pairs once, for the largest threshold
+    const graph_utils::ConsistencyDistances distances =
+        pairwise_consistency_.computeConsistencyDistances(*std::max_element(thresholds.begin(), thresholds.end()));
+
+    for (const double& threshold : thresholds) {
+        FMC::CGraphIO gio;
+        if (options_.use_packed_consistency_matrix) {
+            loadMaxCliqueGraph(distances.computePackedConsistencyMatrix(threshold), options_.export_consistency_matrix, gio);
+        } else {
+            loadMaxCliqueGraph(distances.computeConsistencyGraph(threshold), options_.export_consistency_matrix, gio);
+        }
+        std::vector<int> max_clique_data;
+        max_clique_sizes.push_back(findMaxClique(gio, options_.nb_threads, options_.use_bitset_max_clique, max_clique_data));
+    }
+    return max_clique_sizes;
+}
+
+}
@@ -0,0 +1,78 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "graph_utils/consistency_distances.h"
+
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+
+namespace graph_utils {
+
+ConsistencyDistances::ConsistencyDistances(): nb_vertices_(0), max_threshold_(0) {}
+
+ConsistencyDistances::ConsistencyDistances(const size_t& nb_vertices, const double& max_threshold, std::vector<Entries>& entry_buffers):
+    nb_vertices_(nb_vertices), max_threshold_(max_threshold) {
+    size_t nb_entries = 0;
+    for (const auto& entries: entry_buffers) {
+        nb_entries += entries.size();
+    }
+    entries_.reserve(nb_entries);
+    for (auto& entries: entry_buffers) {
+        entries_.insert(entries_.end(), entries.begin(), entries.end());
+        Entries().swap(entries);
+    }
+
+    // The buffers are filled in any order by the threads
+    std::sort(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+        return a.u < b.u || (a.u == b.u && a.v < b.v);
+    });
+}
+
+size_t ConsistencyDistances::getNbVertices() const {
+    return nb_vertices_;
+}
+
+double ConsistencyDistances::getMaxThreshold() const {
+    return max_threshold_;
+}
+
+const ConsistencyDistances::Entries& ConsistencyDistances::getEntries() const {
+    return entries_;
+}
+
+ConsistencyGraph ConsistencyDistances::computeConsistencyGraph(const double& threshold) const {
+    if (threshold > max_threshold_) {
+        std::cerr << "Threshold " << threshold << " above the maximum threshold " << max_threshold_ << " of the distances" << std::endl;
+        std::abort();
+    }
+    // Compared in single precision as stored, so that both forms of the graph have the same edges
+    const float float_threshold = static_cast<float>(threshold);
+    std::vector<ConsistencyGraph::Edges> edge_buffers(1);
+    for (const Entry& entry: entries_) {
+        if (entry.distance < float_threshold) {
+            edge_buffers[0].emplace_back(entry.u, entry.v);
+        }
+    }
+    return ConsistencyGraph(nb_vertices_, edge_buffers);
+}
+
+PackedConsistencyMatrix ConsistencyDistances::computePackedConsistencyMatrix(const double& threshold) const {
+    if (threshold > max_threshold_) {
+        std::cerr << "Threshold " << threshold << " above the maximum threshold " << max_threshold_ << " of the distances" << std::endl;
+        std::abort();
+    }
+    const float float_threshold = static_cast<float>(threshold);
+    PackedConsistencyMatrix consistency_matrix(nb_vertices_);
+    for (const Entry& entry: entries_) {
+        if (entry.distance < float_threshold) {
+            consistency_matrix.set(entry.u, entry.v);
+        }
+    }
+    return consistency_matrix;
+}
+
+size_t ConsistencyDistances::getMemoryUsage() const {
+    return entries_.capacity() * sizeof(Entry);
+}
+
+}
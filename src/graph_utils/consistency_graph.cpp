@@ -0,0 +1,123 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "graph_utils/consistency_graph.h"
+
+#include <algorithm>
+
+namespace graph_utils {
+
+ConsistencyGraph::ConsistencyGraph(): offsets_(1, 0) {}
+
+ConsistencyGraph::ConsistencyGraph(const size_t& nb_vertices, std::vector<Edges>& edge_buffers): offsets_(nb_vertices + 1, 0) {
+    // Degrees, then offsets by prefix sum
+    for (const auto& edges: edge_buffers) {
+        for (const auto& edge: edges) {
+            offsets_[edge.first + 1]++;
+            offsets_[edge.second + 1]++;
+        }
+    }
+    for (size_t vertex = 0; vertex < nb_vertices; vertex++) {
+        offsets_[vertex + 1] += offsets_[vertex];
+    }
+
+    // Each edge goes in the adjacency lists of its two vertices
+    neighbors_.resize(offsets_[nb_vertices]);
+    std::vector<size_t> positions(offsets_.begin(), offsets_.end() - 1);
+    for (auto& edges: edge_buffers) {
+        for (const auto& edge: edges) {
+            neighbors_[positions[edge.first]++] = edge.second;
+            neighbors_[positions[edge.second]++] = edge.first;
+        }
+        Edges().swap(edges);
+    }
+
+    // The buffers are filled in any order by the threads
+    for (size_t vertex = 0; vertex < nb_vertices; vertex++) {
+        std::sort(neighbors_.begin() + offsets_[vertex], neighbors_.begin() + offsets_[vertex + 1]);
+    }
+}
+
+ConsistencyGraph::ConsistencyGraph(const DynamicConsistencyGraph& graph): offsets_(graph.getNbVertices() + 1, 0) {
+    for (size_t vertex = 0; vertex < graph.getNbVertices(); vertex++) {
+        offsets_[vertex + 1] = offsets_[vertex] + graph.getNeighbors(vertex).size();
+    }
+    neighbors_.reserve(offsets_.back());
+    for (size_t vertex = 0; vertex < graph.getNbVertices(); vertex++) {
+        neighbors_.insert(neighbors_.end(), graph.getNeighbors(vertex).begin(), graph.getNeighbors(vertex).end());
+    }
+}
+
+size_t ConsistencyGraph::getNbVertices() const {
+    return offsets_.size() - 1;
+}
+
+size_t ConsistencyGraph::getNbEdges() const {
+    return neighbors_.size() / 2;
+}
+
+size_t ConsistencyGraph::getDegree(const uint32_t& vertex) const {
+    return offsets_[vertex + 1] - offsets_[vertex];
+}
+
+const uint32_t* ConsistencyGraph::beginNeighbors(const uint32_t& vertex) const {
+    return neighbors_.data() + offsets_[vertex];
+}
+
+const uint32_t* ConsistencyGraph::endNeighbors(const uint32_t& vertex) const {
+    return neighbors_.data() + offsets_[vertex + 1];
+}
+
+bool ConsistencyGraph::hasEdge(const uint32_t& u, const uint32_t& v) const {
+    return std::binary_search(beginNeighbors(u), endNeighbors(u), v);
+}
+
+const std::vector<size_t>& ConsistencyGraph::getOffsets() const {
+    return offsets_;
+}
+
+const std::vector<uint32_t>& ConsistencyGraph::getNeighbors() const {
+    return neighbors_;
+}
+
+size_t ConsistencyGraph::getMemoryUsage() const {
+    return offsets_.capacity() * sizeof(size_t) + neighbors_.capacity() * sizeof(uint32_t);
+}
+
+DynamicConsistencyGraph::DynamicConsistencyGraph(): nb_edges_(0) {}
+
+void DynamicConsistencyGraph::addVertices(const size_t& nb_new_vertices, std::vector<ConsistencyGraph::Edges>& edge_buffers) {
+    ConsistencyGraph::Edges edges;
+    for (auto& buffer: edge_buffers) {
+        edges.insert(edges.end(), buffer.begin(), buffer.end());
+        ConsistencyGraph::Edges().swap(buffer);
+    }
+
+    // The second vertex of each edge is new, so it is larger than all the neighbors already
+    // in the adjacency lists: appending the edges sorted by (v, u) keeps the lists sorted
+    std::sort(edges.begin(), edges.end(), [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+        return a.second < b.second || (a.second == b.second && a.first < b.first);
+    });
+    // The smaller neighbors of a new vertex go before its larger ones
+    adjacency_lists_.resize(adjacency_lists_.size() + nb_new_vertices);
+    for (const auto& edge: edges) {
+        adjacency_lists_[edge.second].push_back(edge.first);
+    }
+    for (const auto& edge: edges) {
+        adjacency_lists_[edge.first].push_back(edge.second);
+    }
+    nb_edges_ += edges.size();
+}
+
+size_t DynamicConsistencyGraph::getNbVertices() const {
+    return adjacency_lists_.size();
+}
+
+size_t DynamicConsistencyGraph::getNbEdges() const {
+    return nb_edges_;
+}
+
+const std::vector<uint32_t>& DynamicConsistencyGraph::getNeighbors(const uint32_t& vertex) const {
+    return adjacency_lists_[vertex];
+}
+
+}
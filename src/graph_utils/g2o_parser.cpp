@@ -0,0 +1,414 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "graph_utils/g2o_parser.h"
+#include "graph_utils/mapped_file.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <locale.h>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <eigen3/Eigen/Dense>
+
+namespace graph_utils {
+
+namespace {
+
+/** Exact powers of ten, used by the fast path of parseDouble */
+const double POWERS_OF_TEN[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+inline bool isBlank(const char& c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(const char& c) {
+    return c >= '0' && c <= '9';
+}
+
+inline void skipBlanks(const char*& cursor, const char* end) {
+    while (cursor < end && isBlank(*cursor)) {
+        cursor++;
+    }
+}
+
+inline void skipLine(const char*& cursor, const char* end) {
+    const char* new_line = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+    cursor = (new_line == nullptr) ? end : new_line + 1;
+}
+
+/** Parses an unsigned integer, returns false if no digit was found */
+inline bool parseUnsigned(const char*& cursor, const char* end, size_t& value) {
+    skipBlanks(cursor, end);
+    const char* start = cursor;
+    value = 0;
+    while (cursor < end && isDigit(*cursor)) {
+        value = value * 10 + (*cursor - '0');
+        cursor++;
+    }
+    return cursor != start;
+}
+
+/** Slow path of parseDouble, strtod in the "C" locale */
+bool parseDoubleFallback(const char*& cursor, const char* end, double& value) {
+    static const locale_t c_locale = newlocale(LC_ALL_MASK, "C", (locale_t) 0);
+
+    // The mapped buffer is not null terminated
+    char buffer[128];
+    size_t length = 0;
+    while (cursor + length < end && length < sizeof(buffer) - 1 &&
+           !isBlank(cursor[length]) && cursor[length] != '\n') {
+        buffer[length] = cursor[length];
+        length++;
+    }
+    buffer[length] = '\0';
+
+    char* parsed_end;
+    value = strtod_l(buffer, &parsed_end, c_locale);
+    cursor += parsed_end - buffer;
+    return parsed_end != buffer;
+}
+
+/** Parses a decimal floating point number.
+ *
+ * When the significand fits in 53 bits and the decimal exponent is small, the result
+ * of a single multiplication or division by an exact power of ten is correctly rounded
+ * (Clinger's fast path), so the value is identical to the one given by strtod.
+ * Other inputs are delegated to strtod.
+ */
+inline bool parseDouble(const char*& cursor, const char* end, double& value) {
+    skipBlanks(cursor, end);
+    const char* start = cursor;
+
+    bool is_negative = false;
+    if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+        is_negative = *cursor == '-';
+        cursor++;
+    }
+
+    uint64_t significand = 0;
+    int nb_digits = 0, exponent = 0;
+    while (cursor < end && isDigit(*cursor)) {
+        significand = significand * 10 + (*cursor - '0');
+        nb_digits += (significand != 0);
+        cursor++;
+    }
+    if (cursor < end && *cursor == '.') {
+        cursor++;
+        while (cursor < end && isDigit(*cursor)) {
+            significand = significand * 10 + (*cursor - '0');
+            nb_digits += (significand != 0);
+            exponent--;
+            cursor++;
+        }
+    }
+    if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+        cursor++;
+        bool is_exponent_negative = false;
+        if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+            is_exponent_negative = *cursor == '-';
+            cursor++;
+        }
+        int explicit_exponent = 0;
+        while (cursor < end && isDigit(*cursor)) {
+            if (explicit_exponent < 10000) {
+                explicit_exponent = explicit_exponent * 10 + (*cursor - '0');
+            }
+            cursor++;
+        }
+        exponent += is_exponent_negative ? -explicit_exponent : explicit_exponent;
+    }
+
+    const bool is_fast_path = nb_digits <= 15 && exponent >= -22 && exponent <= 22 &&
+                              cursor != start && (cursor == end || isBlank(*cursor) || *cursor == '\n');
+    if (!is_fast_path) {
+        cursor = start;
+        return parseDoubleFallback(cursor, end, value);
+    }
+
+    value = static_cast<double>(significand);
+    if (exponent < 0) {
+        value /= POWERS_OF_TEN[-exponent];
+    } else {
+        value *= POWERS_OF_TEN[exponent];
+    }
+    if (is_negative) {
+        value = -value;
+    }
+    return true;
+}
+
+inline bool parseDoubles(const char*& cursor, const char* end, double* values, const int& nb_values) {
+    for (int k = 0; k < nb_values; k++) {
+        if (!parseDouble(cursor, end, values[k])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool matchesToken(const char* token, const size_t& token_length, const char* expected) {
+    return token_length == std::strlen(expected) && std::memcmp(token, expected, token_length) == 0;
+}
+
+/** Tokenizes the lines in [cursor, end) and hands each parsed transform to store_transform.
+ * Returns the degrees of freedom of the last edge, -1 if there is none.
+ */
+template <typename StoreFunction>
+uint8_t tokenizeG2o(const char* cursor, const char* end, StoreFunction store_transform) {
+    // A single pose that will be filled
+    graph_utils::Transform transform;
+    transform.is_loop_closure = false;
+
+    // Preallocate various useful quantities
+    double measurement[7], information[21];
+    size_t i, j;
+
+    uint8_t nb_degrees_freedom = -1;
+
+    while (cursor < end) {
+        // Extract the first token of the line
+        skipBlanks(cursor, end);
+        const char* token = cursor;
+        while (cursor < end && !isBlank(*cursor) && *cursor != '\n') {
+            cursor++;
+        }
+        const size_t token_length = cursor - token;
+
+        bool is_valid = true;
+        if (token_length == 0) {
+            // Empty line
+            skipLine(cursor, end);
+            continue;
+        } else if (matchesToken(token, token_length, "EDGE_SE2")) {
+            // This is a 2D pose measurement
+            nb_degrees_freedom = 3;
+            is_valid = parseUnsigned(cursor, end, i) && parseUnsigned(cursor, end, j) &&
+                       parseDoubles(cursor, end, measurement, 3) &&
+                       parseDoubles(cursor, end, information, 6);
+            fillTransformSE2(i, j, measurement, information, transform);
+        } else if (matchesToken(token, token_length, "EDGE_SE3:QUAT")) {
+            // This is a 3D pose measurement
+            nb_degrees_freedom = 6;
+            is_valid = parseUnsigned(cursor, end, i) && parseUnsigned(cursor, end, j) &&
+                       parseDoubles(cursor, end, measurement, 7) &&
+                       parseDoubles(cursor, end, information, 21);
+            fillTransformSE3(i, j, measurement, information, transform);
+        } else if (matchesToken(token, token_length, "VERTEX_SE2") ||
+                   matchesToken(token, token_length, "VERTEX_SE3:QUAT")) {
+            // This is just initialization information, so do nothing
+            skipLine(cursor, end);
+            continue;
+        } else {
+            std::cout << "Error: unrecognized type: " << std::string(token, token_length) << "!" << std::endl;
+            assert(false);
+        }
+        if (!is_valid) {
+            std::cout << "Error: malformed line: " << std::string(token, cursor - token) << std::endl;
+            assert(false);
+        }
+        skipLine(cursor, end);
+
+        store_transform(transform);
+    }
+
+    return nb_degrees_freedom;
+}
+
+}
+
+uint8_t parseG2ofileMapped(const std::string &file_name, size_t &num_poses,
+    Transforms& transforms,
+    LoopClosures& loop_closures,
+    const bool& only_loop_closures) {
+
+    MappedFile file(file_name);
+    if (!file.isOpen()) {
+        std::cerr << "Error while opening the file" << std::endl;
+        std::abort();
+    }
+
+    // One edge per line at most
+    transforms.transforms.reserve(transforms.transforms.size() + std::count(file.data(), file.data() + file.size(), '\n') + 1);
+
+    num_poses = 0;
+    bool is_first_iteration = true;
+    uint8_t nb_degrees_freedom = tokenizeG2o(file.data(), file.data() + file.size(),
+        [&](Transform& transform) {
+            storeParsedTransform(transform, num_poses, is_first_iteration, transforms, loop_closures, only_loop_closures);
+        });
+
+    num_poses++;
+    return nb_degrees_freedom;
+}
+
+uint8_t parseG2ofileParallel(const std::string &file_name, size_t &num_poses,
+    Transforms& transforms,
+    LoopClosures& loop_closures,
+    const bool& only_loop_closures,
+    size_t nb_threads) {
+
+    MappedFile file(file_name);
+    if (!file.isOpen()) {
+        std::cerr << "Error while opening the file" << std::endl;
+        std::abort();
+    }
+
+    if (nb_threads == 0) {
+        nb_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // Split the file in chunks ending on line boundaries
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+    std::vector<const char*> chunk_bounds(1, begin);
+    for (size_t chunk = 1; chunk < nb_threads; chunk++) {
+        const char* bound = std::max(chunk_bounds.back(), begin + file.size() * chunk / nb_threads);
+        skipLine(bound, end);
+        if (bound > chunk_bounds.back() && bound < end) {
+            chunk_bounds.push_back(bound);
+        }
+    }
+    chunk_bounds.push_back(end);
+    const size_t nb_chunks = chunk_bounds.size() - 1;
+
+    // Parse each chunk in its own edge buffer
+    std::vector<std::vector<Transform>> chunk_transforms(nb_chunks);
+    std::vector<uint8_t> chunk_degrees_freedom(nb_chunks);
+    auto parse_chunk = [&](const size_t& chunk) {
+        // Rough estimate of the number of edges, one EDGE_SE2 line is about 100 bytes
+        chunk_transforms[chunk].reserve((chunk_bounds[chunk + 1] - chunk_bounds[chunk]) / 100);
+        chunk_degrees_freedom[chunk] = tokenizeG2o(chunk_bounds[chunk], chunk_bounds[chunk + 1],
+            [&](const Transform& transform) {
+                chunk_transforms[chunk].push_back(transform);
+            });
+    };
+    std::vector<std::thread> threads;
+    for (size_t chunk = 1; chunk < nb_chunks; chunk++) {
+        threads.emplace_back(parse_chunk, chunk);
+    }
+    parse_chunk(0);
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    // Deterministic post-pass: the odometry/loop closure classification depends on
+    // the poses seen before each edge, so the buffers are stored in file order.
+    size_t nb_transforms = 0;
+    for (const auto& buffer: chunk_transforms) {
+        nb_transforms += buffer.size();
+    }
+    transforms.transforms.reserve(transforms.transforms.size() + nb_transforms);
+
+    num_poses = 0;
+    bool is_first_iteration = true;
+    uint8_t nb_degrees_freedom = -1;
+    for (size_t chunk = 0; chunk < nb_chunks; chunk++) {
+        for (auto& transform: chunk_transforms[chunk]) {
+            storeParsedTransform(transform, num_poses, is_first_iteration, transforms, loop_closures, only_loop_closures);
+        }
+        std::vector<Transform>().swap(chunk_transforms[chunk]);
+        if (chunk_degrees_freedom[chunk] != (uint8_t) -1) {
+            nb_degrees_freedom = chunk_degrees_freedom[chunk];
+        }
+    }
+
+    num_poses++;
+    return nb_degrees_freedom;
+}
+
+void fillTransformSE2(const size_t& i, const size_t& j, const double* measurement,
+    const double* information, Transform& transform) {
+    // Pose ids
+    transform.i = i;
+    transform.j = j;
+
+    // Raw measurements
+    const double& dtheta = measurement[2];
+    transform.pose.pose.position.x = measurement[0];
+    transform.pose.pose.position.y = measurement[1];
+    transform.pose.pose.position.z = 0;
+    transform.pose.pose.orientation.x = 0;
+    transform.pose.pose.orientation.y = 0;
+    transform.pose.pose.orientation.z = sin(dtheta/2);
+    transform.pose.pose.orientation.w = cos(dtheta/2);
+
+    // Covariance
+    Eigen::Matrix3d infomation_matrix, covariance_matrix;
+    infomation_matrix << information[0], information[1], information[2],
+                         information[1], information[3], information[4],
+                         information[2], information[4], information[5];
+    covariance_matrix = infomation_matrix.inverse();
+    transform.pose.covariance[0] = covariance_matrix(0, 0);
+    transform.pose.covariance[1] = covariance_matrix(0, 1);
+    transform.pose.covariance[5] = covariance_matrix(0, 2);
+    transform.pose.covariance[6] = covariance_matrix(1, 0);
+    transform.pose.covariance[7] = covariance_matrix(1, 1);
+    transform.pose.covariance[11] = covariance_matrix(1, 2);
+    transform.pose.covariance[30] = covariance_matrix(2, 0);
+    transform.pose.covariance[31] = covariance_matrix(2, 1);
+    transform.pose.covariance[35] = covariance_matrix(2, 2);
+}
+
+void fillTransformSE3(const size_t& i, const size_t& j, const double* measurement,
+    const double* information, Transform& transform) {
+    // Pose ids
+    transform.i = i;
+    transform.j = j;
+
+    // Raw measurements
+    transform.pose.pose.position.x = measurement[0];
+    transform.pose.pose.position.y = measurement[1];
+    transform.pose.pose.position.z = measurement[2];
+    transform.pose.pose.orientation.x = measurement[3];
+    transform.pose.pose.orientation.y = measurement[4];
+    transform.pose.pose.orientation.z = measurement[5];
+    transform.pose.pose.orientation.w = measurement[6];
+
+    // Covariance (the information matrix is given as its upper triangle, row by row)
+    Eigen::Matrix<double, 6, 6> infomation_matrix, covariance_matrix;
+    int index = 0;
+    for (int row = 0; row < 6; row++) {
+        for (int col = row; col < 6; col++) {
+            infomation_matrix(row, col) = information[index];
+            infomation_matrix(col, row) = information[index];
+            index++;
+        }
+    }
+    covariance_matrix = infomation_matrix.inverse();
+
+    for (int row = 0; row < 6; row++) {
+        for (int col = 0; col < 6; col++) {
+            transform.pose.covariance[row*6+col] = covariance_matrix(row,col);
+        }
+    }
+}
+
+void storeParsedTransform(Transform& transform, size_t& num_poses, bool& is_first_transform,
+    Transforms& transforms, LoopClosures& loop_closures,
+    const bool& only_loop_closures) {
+    // Update maximum value of poses found so far
+    size_t max_pair = std::max<double>(transform.i, transform.j);
+
+    transform.is_loop_closure = only_loop_closures || max_pair <= num_poses;
+    if (transform.is_loop_closure) {
+        loop_closures.emplace_back(std::make_pair(transform.i, transform.j));
+    } else {
+        num_poses = max_pair;
+        transforms.end_id = transform.j;
+    }
+
+    if (is_first_transform) {
+        transforms.start_id = transform.i;
+        is_first_transform = false;
+    }
+
+    transforms.transforms.insert(transform);
+}
+
+}
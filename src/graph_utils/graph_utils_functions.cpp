@@ -1,7 +1,10 @@
 // Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
 
 #include "graph_utils/graph_utils_functions.h"
+#include "graph_utils/g2o_parser.h"
+#include "graph_utils/pose_algebra.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <math.h>
@@ -28,8 +31,7 @@ uint8_t parseG2ofile(const std::string &file_name, size_t &num_poses,
   std::string token;
 
   // Preallocate various useful quantities
-  double dx, dy, dz, dtheta, dqx, dqy, dqz, dqw, I11, I12, I13, I14, I15, I16,
-      I22, I23, I24, I25, I26, I33, I34, I35, I36, I44, I45, I46, I55, I56, I66;
+  double measurement[7], information[21];
 
   size_t i, j;
 
@@ -49,86 +51,41 @@ uint8_t parseG2ofile(const std::string &file_name, size_t &num_poses,
     // Construct a stream from the string
     std::stringstream strstrm(line);
 
-    // Extract the first token from the string
-    strstrm >> token;
+    // Extract the first token from the string, skipping empty lines
+    if (!(strstrm >> token)) {
+      continue;
+    }
 
     if (token == "EDGE_SE2") {
       // This is a 2D pose measurement
       nb_degrees_freedom = 3;
 
       // Extract formatted output
-      strstrm >> i >> j >> dx >> dy >> dtheta >> I11 >> I12 >> I13 >> I22 >>
-          I23 >> I33;
-
-      // Fill in elements of this measurement
-
-      // Pose ids
-      transform.i = i;
-      transform.j = j;
-
-      // Raw measurements
-      transform.pose.pose.position.x = dx;
-      transform.pose.pose.position.y = dy;
-      transform.pose.pose.position.z = 0;
-      transform.pose.pose.orientation.x = 0;
-      transform.pose.pose.orientation.y = 0;
-      transform.pose.pose.orientation.z = sin(dtheta/2);
-      transform.pose.pose.orientation.w = cos(dtheta/2);
-
-      // Covariance
-      Eigen::Matrix3d infomation_matrix, covariance_matrix;
-      infomation_matrix << I11, I12, I13, I12, I22, I23, I13, I23, I33;
-      covariance_matrix = infomation_matrix.inverse();
-      transform.pose.covariance[0] = covariance_matrix(0, 0);
-      transform.pose.covariance[1] = covariance_matrix(0, 1);
-      transform.pose.covariance[5] = covariance_matrix(0, 2);
-      transform.pose.covariance[6] = covariance_matrix(1, 0);
-      transform.pose.covariance[7] = covariance_matrix(1, 1);
-      transform.pose.covariance[11] = covariance_matrix(1, 2);
-      transform.pose.covariance[30] = covariance_matrix(2, 0);
-      transform.pose.covariance[31] = covariance_matrix(2, 1);
-      transform.pose.covariance[35] = covariance_matrix(2, 2);
+      strstrm >> i >> j;
+      for (int k = 0; k < 3; k++) {
+        strstrm >> measurement[k];
+      }
+      for (int k = 0; k < 6; k++) {
+        strstrm >> information[k];
+      }
+
+      fillTransformSE2(i, j, measurement, information, transform);
 
     } else if (token == "EDGE_SE3:QUAT") {
       // This is a 3D pose measurement
       nb_degrees_freedom = 6;
 
       // Extract formatted output
-      strstrm >> i >> j >> dx >> dy >> dz >> dqx >> dqy >> dqz >> dqw >> I11 >>
-          I12 >> I13 >> I14 >> I15 >> I16 >> I22 >> I23 >> I24 >> I25 >> I26 >>
-          I33 >> I34 >> I35 >> I36 >> I44 >> I45 >> I46 >> I55 >> I56 >> I66;
-
-      // Fill in elements of the measurement
-
-      // Pose ids
-      transform.i = i;
-      transform.j = j;
-
-      // Raw measurements
-      transform.pose.pose.position.x = dx;
-      transform.pose.pose.position.y = dy;
-      transform.pose.pose.position.z = dz;
-      transform.pose.pose.orientation.x = dqx;
-      transform.pose.pose.orientation.y = dqy;
-      transform.pose.pose.orientation.z = dqz;
-      transform.pose.pose.orientation.w = dqw;
-
-      // Covariance
-      Eigen::Matrix<double, 6, 6> infomation_matrix, covariance_matrix;
-      infomation_matrix <<  I11, I12, I13, I14, I15, I16,
-                            I12, I22, I23, I24, I25, I26,
-                            I13, I23, I33, I34, I35, I36,
-                            I14, I24, I34, I44, I45, I46,
-                            I15, I25, I35, I45, I55, I56,
-                            I16, I26, I36, I46, I56, I66;
-      covariance_matrix = infomation_matrix.inverse();
-
-      for (int i = 0; i < 6; i++) {
-          for (int j = 0; j < 6; j++) {
-              transform.pose.covariance[i*6+j] = covariance_matrix(i,j);
-          }
+      strstrm >> i >> j;
+      for (int k = 0; k < 7; k++) {
+        strstrm >> measurement[k];
+      }
+      for (int k = 0; k < 21; k++) {
+        strstrm >> information[k];
       }
 
+      fillTransformSE3(i, j, measurement, information, transform);
+
     } else if ((token == "VERTEX_SE2") || (token == "VERTEX_SE3:QUAT")) {
       // This is just initialization information, so do nothing
       continue;
@@ -137,23 +94,7 @@ uint8_t parseG2ofile(const std::string &file_name, size_t &num_poses,
       assert(false);
     }
 
-    // Update maximum value of poses found so far
-    size_t max_pair = std::max<double>(transform.i, transform.j);
-    
-    if (only_loop_closures || max_pair <= num_poses) {
-      transform.is_loop_closure = true;
-      loop_closures.emplace_back(std::make_pair(i,j));
-    } else {
-      num_poses = max_pair;
-      transforms.end_id = j;
-    }
-
-    if (is_first_iteration) {
-      transforms.start_id = i;
-      is_first_iteration = false;
-    }
-
-    transforms.transforms.emplace(std::make_pair(std::make_pair(i,j), transform));
+    storeParsedTransform(transform, num_poses, is_first_iteration, transforms, loop_closures, only_loop_closures);
   }
 
   infile.close();
@@ -165,6 +106,15 @@ uint8_t parseG2ofile(const std::string &file_name, size_t &num_poses,
 void poseCompose(const geometry_msgs::PoseWithCovariance &a,
                 const geometry_msgs::PoseWithCovariance &b,
                 geometry_msgs::PoseWithCovariance &out) {
+#ifdef USE_NATIVE_POSE_ALGEBRA
+  PoseSE3 A, B, OUT;
+
+  fromPoseWithCovariance(a, A);
+  fromPoseWithCovariance(b, B);
+
+  composeSE3(A, B, OUT);
+  toPoseWithCovariance(OUT, out);
+#else
   CPose3DPDFGaussian A(UNINITIALIZED_POSE), B(UNINITIALIZED_POSE);
 
   mrpt_bridge::convert(a, A);
@@ -172,10 +122,19 @@ void poseCompose(const geometry_msgs::PoseWithCovariance &a,
 
   const CPose3DPDFGaussian OUT = A + B;
   mrpt_bridge::convert(OUT, out);
+#endif
 }
 
 void poseInverse(const geometry_msgs::PoseWithCovariance &a,
                 geometry_msgs::PoseWithCovariance &out) {
+#ifdef USE_NATIVE_POSE_ALGEBRA
+  PoseSE3 A, OUT;
+
+  fromPoseWithCovariance(a, A);
+
+  inverseSE3(A, OUT);
+  toPoseWithCovariance(OUT, out);
+#else
   CPose3DPDFGaussian A(UNINITIALIZED_POSE);
 
   mrpt_bridge::convert(a, A);
@@ -183,11 +142,21 @@ void poseInverse(const geometry_msgs::PoseWithCovariance &a,
   CPose3DPDFGaussian OUT;
   A.inverse(OUT);
   mrpt_bridge::convert(OUT, out);
+#endif
 }
 
 void poseInverseCompose(const geometry_msgs::PoseWithCovariance &a,
                                   const geometry_msgs::PoseWithCovariance &b,
                                   geometry_msgs::PoseWithCovariance &out) {
+#ifdef USE_NATIVE_POSE_ALGEBRA
+  PoseSE3 A, B, OUT;
+
+  fromPoseWithCovariance(a, A);
+  fromPoseWithCovariance(b, B);
+
+  inverseComposeSE3(A, B, OUT);
+  toPoseWithCovariance(OUT, out);
+#else
   CPose3DPDFGaussian A(UNINITIALIZED_POSE), B(UNINITIALIZED_POSE);
 
   mrpt_bridge::convert(a, A);
@@ -195,8 +164,57 @@ void poseInverseCompose(const geometry_msgs::PoseWithCovariance &a,
 
   const CPose3DPDFGaussian OUT = A - B;
   mrpt_bridge::convert(OUT, out);
+#endif
+}
+
+#ifndef USE_NATIVE_POSE_ALGEBRA
+namespace {
+
+/** Composition of fixed-size poses through their geometry_msgs form, with one of the MRPT functions above */
+template <typename Pose, typename Function>
+void applyWithMrpt(const Pose& a, const Pose& b, Pose& out, Function function) {
+  geometry_msgs::PoseWithCovariance A, B, OUT;
+  toPoseWithCovariance(a, A);
+  toPoseWithCovariance(b, B);
+  function(A, B, OUT);
+  fromPoseWithCovariance(OUT, out);
+}
+
+template <typename Pose>
+void inverseWithMrpt(const Pose& a, Pose& out) {
+  geometry_msgs::PoseWithCovariance A, OUT;
+  toPoseWithCovariance(a, A);
+  poseInverse(A, OUT);
+  fromPoseWithCovariance(OUT, out);
+}
+
+}
+
+void compose(const PoseSE2& a, const PoseSE2& b, PoseSE2& out) {
+  applyWithMrpt(a, b, out, poseCompose);
+}
+
+void compose(const PoseSE3& a, const PoseSE3& b, PoseSE3& out) {
+  applyWithMrpt(a, b, out, poseCompose);
+}
+
+void inverseCompose(const PoseSE2& a, const PoseSE2& b, PoseSE2& out) {
+  applyWithMrpt(a, b, out, poseInverseCompose);
 }
 
+void inverseCompose(const PoseSE3& a, const PoseSE3& b, PoseSE3& out) {
+  applyWithMrpt(a, b, out, poseInverseCompose);
+}
+
+void inverse(const PoseSE2& a, PoseSE2& out) {
+  inverseWithMrpt(a, out);
+}
+
+void inverse(const PoseSE3& a, PoseSE3& out) {
+  inverseWithMrpt(a, out);
+}
+#endif
+
 Trajectory buildTrajectory(const Transforms& transforms) {
     // Initialization
     Trajectory trajectory;
@@ -204,28 +222,29 @@ Trajectory buildTrajectory(const Transforms& transforms) {
     trajectory.end_id = transforms.end_id;
     size_t current_pose_id = trajectory.start_id;
     geometry_msgs::PoseWithCovariance temp_pose, total_pose;
+    if (transforms.end_id >= transforms.start_id) {
+        trajectory.trajectory_poses.reserve(transforms.end_id - transforms.start_id + 1);
+    }
 
     // Add first pose at the origin
     graph_utils::TrajectoryPose current_pose;
     current_pose.id = current_pose_id;
     current_pose.pose.pose.orientation.w = 1;
     temp_pose = current_pose.pose;
-    trajectory.trajectory_poses.insert(std::make_pair(current_pose_id, current_pose));
+    trajectory.trajectory_poses.push_back(current_pose);
 
     // Initialization
-    std::pair<size_t, size_t> temp_pair = std::make_pair(current_pose_id, current_pose_id + 1);
-    auto temp_it = transforms.transforms.find(temp_pair);
+    size_t temp_index = transforms.transforms.find(current_pose_id, current_pose_id + 1);
 
     // Compositions in chain on the trajectory transforms.
-    while (temp_it != transforms.transforms.end() && !(*temp_it).second.is_loop_closure) {
-        graph_utils::poseCompose(temp_pose, (*temp_it).second.pose, total_pose);             
+    while (temp_index != TransformStore::NOT_FOUND && !transforms.transforms.isLoopClosure(temp_index)) {
+        graph_utils::poseCompose(temp_pose, transforms.transforms.getPose(temp_index), total_pose);             
         temp_pose = total_pose;
         current_pose_id++;
         current_pose.id = current_pose_id;
         current_pose.pose = total_pose;
-        trajectory.trajectory_poses.insert(std::make_pair(current_pose_id, current_pose));
-        temp_pair = std::make_pair(current_pose_id, current_pose_id + 1);
-        temp_it = transforms.transforms.find(temp_pair);
+        trajectory.trajectory_poses.push_back(current_pose);
+        temp_index = transforms.transforms.find(current_pose_id, current_pose_id + 1);
     }
 
     return trajectory;
@@ -255,8 +274,45 @@ void printConsistencyGraph(const Eigen::MatrixXi& consistency_matrix, const std:
     output_file.close();
 }
 
-bool isInTrajectory(const Trajectory& trajectory, const size_t& pose_id) {
-  return trajectory.trajectory_poses.find(pose_id) != trajectory.trajectory_poses.end();
+void printConsistencyGraph(const ConsistencyGraph& consistency_graph, const std::string& file_name) {
+    // Format edges, each one once from its lowest vertex
+    std::stringstream ss;
+    for (uint32_t i = 0; i < consistency_graph.getNbVertices(); i++) {
+      for (const uint32_t* j = std::upper_bound(consistency_graph.beginNeighbors(i), consistency_graph.endNeighbors(i), i);
+           j != consistency_graph.endNeighbors(i); j++) {
+        ss << i+1 << " " << *j+1 << std::endl;
+      }
+    }
+
+    // Write to file
+    std::ofstream output_file;
+    output_file.open(file_name);
+    output_file << "%%MatrixMarket matrix coordinate pattern symmetric" << std::endl;
+    output_file << consistency_graph.getNbVertices() << " " << consistency_graph.getNbVertices() << " " << consistency_graph.getNbEdges() << std::endl;
+    output_file << ss.str();
+    output_file.close();
+}
+
+void printConsistencyGraph(const PackedConsistencyMatrix& consistency_matrix, const std::string& file_name) {
+    // Format edges, scanning the rows word by word
+    std::stringstream ss;
+    const size_t nb_vertices = consistency_matrix.getNbVertices();
+    for (size_t i = 0; i < nb_vertices; i++) {
+      const PackedConsistencyMatrix::RowView row = consistency_matrix.getRow(i);
+      for (size_t column = i + 1; column < nb_vertices; column += 64) {
+        for (uint64_t word = row.getWord(column); word != 0; word &= word - 1) {
+          ss << i+1 << " " << column + __builtin_ctzll(word) + 1 << std::endl;
+        }
+      }
+    }
+
+    // Write to file
+    std::ofstream output_file;
+    output_file.open(file_name);
+    output_file << "%%MatrixMarket matrix coordinate pattern symmetric" << std::endl;
+    output_file << nb_vertices << " " << nb_vertices << " " << consistency_matrix.getNbEdges() << std::endl;
+    output_file << ss.str();
+    output_file.close();
 }
 
 void printConsistentLoopClosures(const LoopClosures& loop_closures, const std::vector<int>& max_clique_data, const std::string& file_name){
@@ -0,0 +1,62 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "graph_utils/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace graph_utils {
+
+MappedFile::MappedFile(const std::string& file_name):
+    file_descriptor_(-1), data_(nullptr), size_(0), is_open_(false) {
+    file_descriptor_ = open(file_name.c_str(), O_RDONLY);
+    if (file_descriptor_ < 0) {
+        return;
+    }
+
+    struct stat file_stat;
+    if (fstat(file_descriptor_, &file_stat) != 0) {
+        return;
+    }
+    size_ = file_stat.st_size;
+
+    // An empty file cannot be mapped, but it is still a valid (empty) input
+    if (size_ == 0) {
+        is_open_ = true;
+        return;
+    }
+
+    void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor_, 0);
+    if (mapping == MAP_FAILED) {
+        return;
+    }
+    // The whole file is read front to back
+    madvise(mapping, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(mapping);
+    is_open_ = true;
+}
+
+MappedFile::~MappedFile() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+    if (file_descriptor_ >= 0) {
+        close(file_descriptor_);
+    }
+}
+
+bool MappedFile::isOpen() const {
+    return is_open_;
+}
+
+const char* MappedFile::data() const {
+    return data_;
+}
+
+size_t MappedFile::size() const {
+    return size_;
+}
+
+}
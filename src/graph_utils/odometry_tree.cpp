@@ -0,0 +1,96 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "graph_utils/odometry_tree.h"
+
+namespace graph_utils {
+
+template <typename Pose>
+OdometryTree<Pose>::OdometryTree(): nb_measurements_(0) {}
+
+template <typename Pose>
+OdometryTree<Pose>::OdometryTree(const Transforms& transforms): nb_measurements_(0) {
+    // Length of the odometry chain, as in buildTrajectory
+    std::vector<size_t> indexes;
+    size_t index = transforms.transforms.find(transforms.start_id, transforms.start_id + 1);
+    while (index != TransformStore::NOT_FOUND && !transforms.transforms.isLoopClosure(index)) {
+        indexes.push_back(index);
+        index = transforms.transforms.find(transforms.start_id + indexes.size(), transforms.start_id + indexes.size() + 1);
+    }
+
+    // Leaves, then the internal nodes from the bottom. The nodes whose range wraps around
+    // the leaves when nb_measurements_ is not a power of two are never used by the queries.
+    nb_measurements_ = indexes.size();
+    nodes_.resize(2 * nb_measurements_);
+    for (size_t leaf = 0; leaf < nb_measurements_; leaf++) {
+        fromPoseWithCovariance(transforms.transforms.getPose(indexes[leaf]), nodes_[nb_measurements_ + leaf]);
+    }
+    for (size_t node = nb_measurements_ - (nb_measurements_ > 0); node > 0; node--) {
+        compose(nodes_[2 * node], nodes_[2 * node + 1], nodes_[node]);
+    }
+}
+
+template <typename Pose>
+size_t OdometryTree<Pose>::getNbPoses() const {
+    return nb_measurements_ + 1;
+}
+
+template <typename Pose>
+void OdometryTree<Pose>::getRelativePose(const size_t& index1, const size_t& index2, Pose& result) const {
+    if (index1 < index2) {
+        composeOdometry(index1, index2, result);
+    } else if (index1 > index2) {
+        Pose odometry;
+        composeOdometry(index2, index1, odometry);
+        inverse(odometry, result);
+    } else {
+        // Identity, without uncertainty
+        geometry_msgs::PoseWithCovariance identity;
+        identity.pose.orientation.w = 1;
+        fromPoseWithCovariance(identity, result);
+    }
+}
+
+template <typename Pose>
+void OdometryTree<Pose>::composeOdometry(size_t first, size_t end, Pose& result) const {
+    // Bottom-up traversal : the nodes on the left of the range are composed in order after the
+    // left part, the ones on the right before the right part, the composition is not commutative
+    Pose left, right, composition;
+    bool has_left = false, has_right = false;
+    for (first += nb_measurements_, end += nb_measurements_; first < end; first /= 2, end /= 2) {
+        if (first & 1) {
+            if (has_left) {
+                compose(left, nodes_[first], composition);
+                left = composition;
+            } else {
+                left = nodes_[first];
+                has_left = true;
+            }
+            first++;
+        }
+        if (end & 1) {
+            end--;
+            if (has_right) {
+                compose(nodes_[end], right, composition);
+                right = composition;
+            } else {
+                right = nodes_[end];
+                has_right = true;
+            }
+        }
+    }
+    if (has_left && has_right) {
+        compose(left, right, result);
+    } else {
+        result = has_left ? left : right;
+    }
+}
+
+template <typename Pose>
+size_t OdometryTree<Pose>::getMemoryUsage() const {
+    return nodes_.capacity() * sizeof(Pose);
+}
+
+template class OdometryTree<PoseSE2>;
+template class OdometryTree<PoseSE3>;
+
+}
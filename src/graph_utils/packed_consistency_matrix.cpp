@@ -0,0 +1,136 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "graph_utils/packed_consistency_matrix.h"
+
+#include <algorithm>
+
+namespace graph_utils {
+
+namespace {
+
+const size_t WORD_SIZE = 64;
+
+inline size_t popcount(const uint64_t& word) {
+    return __builtin_popcountll(word);
+}
+
+}
+
+PackedConsistencyMatrix::RowView::RowView(const uint64_t* words, const size_t& first_bit, const size_t& first_column, const size_t& end_column):
+    words_(words), first_bit_(first_bit), first_column_(first_column), end_column_(end_column) {}
+
+size_t PackedConsistencyMatrix::RowView::getFirstColumn() const {
+    return first_column_;
+}
+
+size_t PackedConsistencyMatrix::RowView::getEndColumn() const {
+    return end_column_;
+}
+
+bool PackedConsistencyMatrix::RowView::test(const size_t& column) const {
+    const size_t bit = first_bit_ + column - first_column_;
+    return (words_[bit / WORD_SIZE] >> (bit % WORD_SIZE)) & 1;
+}
+
+uint64_t PackedConsistencyMatrix::RowView::getWord(const size_t& column) const {
+    // The row is not aligned on the words, the 64 bits can span two words (the last one is padding)
+    const size_t bit = first_bit_ + column - first_column_;
+    const size_t shift = bit % WORD_SIZE;
+    uint64_t word = words_[bit / WORD_SIZE] >> shift;
+    if (shift != 0) {
+        word |= words_[bit / WORD_SIZE + 1] << (WORD_SIZE - shift);
+    }
+    const size_t nb_columns = end_column_ - column;
+    if (nb_columns < WORD_SIZE) {
+        word &= (uint64_t(1) << nb_columns) - 1;
+    }
+    return word;
+}
+
+size_t PackedConsistencyMatrix::RowView::count() const {
+    size_t result = 0;
+    for (size_t column = first_column_; column < end_column_; column += WORD_SIZE) {
+        result += popcount(getWord(column));
+    }
+    return result;
+}
+
+PackedConsistencyMatrix::PackedConsistencyMatrix(): PackedConsistencyMatrix(0) {}
+
+PackedConsistencyMatrix::PackedConsistencyMatrix(const size_t& nb_vertices): nb_vertices_(nb_vertices),
+    words_((nb_vertices * (nb_vertices - std::min<size_t>(nb_vertices, 1)) / 2 + WORD_SIZE - 1) / WORD_SIZE + 1, 0) {}
+
+size_t PackedConsistencyMatrix::getNbVertices() const {
+    return nb_vertices_;
+}
+
+size_t PackedConsistencyMatrix::getNbEdges() const {
+    size_t result = 0;
+    for (const uint64_t& word: words_) {
+        result += popcount(word);
+    }
+    return result;
+}
+
+size_t PackedConsistencyMatrix::getBitIndex(const size_t& u, const size_t& v) const {
+    // Rows 0 to u-1 hold (m-1) + (m-2) + ... + (m-u) entries
+    return u * (2 * nb_vertices_ - u - 1) / 2 + v - u - 1;
+}
+
+bool PackedConsistencyMatrix::test(const size_t& u, const size_t& v) const {
+    if (u == v) {
+        return false;
+    }
+    const size_t bit = getBitIndex(std::min(u, v), std::max(u, v));
+    return (words_[bit / WORD_SIZE] >> (bit % WORD_SIZE)) & 1;
+}
+
+void PackedConsistencyMatrix::set(const size_t& u, const size_t& v) {
+    const size_t bit = getBitIndex(u, v);
+    words_[bit / WORD_SIZE] |= uint64_t(1) << (bit % WORD_SIZE);
+}
+
+void PackedConsistencyMatrix::setConcurrently(const size_t& u, const size_t& v) {
+    // Neighboring entries share words, whatever the partition of the pairs between the threads
+    const size_t bit = getBitIndex(u, v);
+    __atomic_fetch_or(&words_[bit / WORD_SIZE], uint64_t(1) << (bit % WORD_SIZE), __ATOMIC_RELAXED);
+}
+
+PackedConsistencyMatrix::RowView PackedConsistencyMatrix::getRow(const size_t& u) const {
+    return RowView(words_.data(), getBitIndex(u, u + 1), u + 1, nb_vertices_);
+}
+
+std::vector<size_t> PackedConsistencyMatrix::computeDegrees() const {
+    std::vector<size_t> degrees(nb_vertices_, 0);
+    for (size_t u = 0; u < nb_vertices_; u++) {
+        const RowView row = getRow(u);
+        for (size_t column = row.getFirstColumn(); column < nb_vertices_; column += WORD_SIZE) {
+            uint64_t word = row.getWord(column);
+            degrees[u] += popcount(word);
+            // Entries below the diagonal
+            for (; word != 0; word &= word - 1) {
+                degrees[column + __builtin_ctzll(word)]++;
+            }
+        }
+    }
+    return degrees;
+}
+
+size_t PackedConsistencyMatrix::intersectRows(const size_t& u, const size_t& w, std::vector<uint64_t>& common) const {
+    const RowView row1 = getRow(u), row2 = getRow(w);
+    const size_t first_column = std::max(u, w) + 1;
+    common.resize((nb_vertices_ - std::min(first_column, nb_vertices_) + WORD_SIZE - 1) / WORD_SIZE);
+    size_t result = 0;
+    for (size_t k = 0; k < common.size(); k++) {
+        const size_t column = first_column + k * WORD_SIZE;
+        common[k] = row1.getWord(column) & row2.getWord(column);
+        result += popcount(common[k]);
+    }
+    return result;
+}
+
+size_t PackedConsistencyMatrix::getMemoryUsage() const {
+    return words_.capacity() * sizeof(uint64_t);
+}
+
+}
@@ -0,0 +1,245 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "graph_utils/pose_graph_binary.h"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace graph_utils {
+
+namespace {
+
+const char POSE_GRAPH_BINARY_MAGIC[4] = {'R', 'M', 'P', 'G'};
+
+static_assert(sizeof(PoseGraphBinaryHeader) == 80, "Unexpected padding in the binary pose graph header");
+
+/** Rows/columns of the geometry_msgs covariance used in 2D (x, y, yaw) */
+const int COVARIANCE_INDEXES_2D[3] = {0, 1, 5};
+
+inline size_t nbCovarianceValues(const uint8_t& nb_degree_freedom) {
+    return nb_degree_freedom * (nb_degree_freedom + 1) / 2;
+}
+
+inline int covarianceIndex(const uint8_t& nb_degree_freedom, const int& k) {
+    return nb_degree_freedom == 3 ? COVARIANCE_INDEXES_2D[k] : k;
+}
+
+/** Appends the packed upper triangle of the covariance */
+void packCovariance(const geometry_msgs::PoseWithCovariance& pose, const uint8_t& nb_degree_freedom, std::vector<double>& values) {
+    for (int row = 0; row < nb_degree_freedom; row++) {
+        for (int col = row; col < nb_degree_freedom; col++) {
+            values.push_back(pose.covariance[covarianceIndex(nb_degree_freedom, row) * 6 + covarianceIndex(nb_degree_freedom, col)]);
+        }
+    }
+}
+
+void unpackCovariance(const double* values, const uint8_t& nb_degree_freedom, geometry_msgs::PoseWithCovariance& pose) {
+    int index = 0;
+    for (int row = 0; row < nb_degree_freedom; row++) {
+        for (int col = row; col < nb_degree_freedom; col++) {
+            const int r = covarianceIndex(nb_degree_freedom, row);
+            const int c = covarianceIndex(nb_degree_freedom, col);
+            pose.covariance[r * 6 + c] = values[index];
+            pose.covariance[c * 6 + r] = values[index];
+            index++;
+        }
+    }
+}
+
+void packPose(const geometry_msgs::PoseWithCovariance& pose, std::vector<double>& values) {
+    values.push_back(pose.pose.position.x);
+    values.push_back(pose.pose.position.y);
+    values.push_back(pose.pose.position.z);
+    values.push_back(pose.pose.orientation.x);
+    values.push_back(pose.pose.orientation.y);
+    values.push_back(pose.pose.orientation.z);
+    values.push_back(pose.pose.orientation.w);
+}
+
+void unpackPose(const double* values, geometry_msgs::PoseWithCovariance& pose) {
+    pose.pose.position.x = values[0];
+    pose.pose.position.y = values[1];
+    pose.pose.position.z = values[2];
+    pose.pose.orientation.x = values[3];
+    pose.pose.orientation.y = values[4];
+    pose.pose.orientation.z = values[5];
+    pose.pose.orientation.w = values[6];
+}
+
+inline uint64_t readUnsigned(const char* record) {
+    uint64_t value;
+    std::memcpy(&value, record, sizeof(value));
+    return value;
+}
+
+/** Reads the pose and covariance that follow the integer fields of a record */
+void readPoseWithCovariance(const char* record, const uint8_t& nb_degree_freedom, geometry_msgs::PoseWithCovariance& pose) {
+    double values[7 + 21];
+    std::memcpy(values, record, (7 + nbCovarianceValues(nb_degree_freedom)) * sizeof(double));
+    unpackPose(values, pose);
+    unpackCovariance(values + 7, nb_degree_freedom, pose);
+}
+
+}
+
+bool writePoseGraphBinary(const std::string& file_name, const size_t& num_poses,
+    const Transforms& transforms, const LoopClosures& loop_closures,
+    const uint8_t& nb_degree_freedom, const Trajectory& trajectory) {
+    std::ofstream output_file(file_name, std::ios::binary);
+    if (!output_file.is_open()) {
+        return false;
+    }
+
+    // Header
+    PoseGraphBinaryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, POSE_GRAPH_BINARY_MAGIC, sizeof(header.magic));
+    header.version = POSE_GRAPH_BINARY_VERSION;
+    header.nb_degree_freedom = nb_degree_freedom;
+    header.num_poses = num_poses;
+    header.transforms_start_id = transforms.start_id;
+    header.transforms_end_id = transforms.end_id;
+    header.nb_transforms = transforms.transforms.size();
+    header.nb_trajectory_poses = trajectory.trajectory_poses.size();
+    if (header.nb_trajectory_poses > 0) {
+        header.trajectory_start_id = trajectory.start_id;
+        header.trajectory_end_id = trajectory.end_id;
+    }
+    header.nb_loop_closures = loop_closures.size();
+    output_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Records, written one at a time through a reused buffer
+    std::vector<double> values;
+    for (size_t index = 0; index < transforms.transforms.size(); index++) {
+        const Transform t = transforms.transforms.at(index);
+        uint64_t ids[3] = {t.i, t.j, t.is_loop_closure};
+        output_file.write(reinterpret_cast<const char*>(ids), sizeof(ids));
+        values.clear();
+        packPose(t.pose, values);
+        packCovariance(t.pose, nb_degree_freedom, values);
+        output_file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+    }
+    for (const auto& p: trajectory.trajectory_poses) {
+        uint64_t id = p.id;
+        output_file.write(reinterpret_cast<const char*>(&id), sizeof(id));
+        values.clear();
+        packPose(p.pose, values);
+        packCovariance(p.pose, nb_degree_freedom, values);
+        output_file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(double));
+    }
+    for (const auto& loop_closure: loop_closures) {
+        uint64_t ids[2] = {loop_closure.first, loop_closure.second};
+        output_file.write(reinterpret_cast<const char*>(ids), sizeof(ids));
+    }
+
+    return output_file.good();
+}
+
+bool isPoseGraphBinaryFile(const std::string& file_name) {
+    return file_name.size() >= POSE_GRAPH_BINARY_EXTENSION.size() &&
+           file_name.compare(file_name.size() - POSE_GRAPH_BINARY_EXTENSION.size(),
+                             POSE_GRAPH_BINARY_EXTENSION.size(), POSE_GRAPH_BINARY_EXTENSION) == 0;
+}
+
+PoseGraphBinaryFile::PoseGraphBinaryFile(const std::string& file_name):
+    file_(file_name), is_valid_(false), nb_covariance_values_(0),
+    transforms_offset_(0), trajectory_offset_(0), loop_closures_offset_(0),
+    transform_record_size_(0), trajectory_record_size_(0) {
+    std::memset(&header_, 0, sizeof(header_));
+    if (!file_.isOpen() || file_.size() < sizeof(header_)) {
+        return;
+    }
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    if (std::memcmp(header_.magic, POSE_GRAPH_BINARY_MAGIC, sizeof(header_.magic)) != 0 ||
+        header_.version != POSE_GRAPH_BINARY_VERSION ||
+        (header_.nb_degree_freedom != 3 && header_.nb_degree_freedom != 6)) {
+        return;
+    }
+
+    // Layout of the sections
+    nb_covariance_values_ = nbCovarianceValues(header_.nb_degree_freedom);
+    transform_record_size_ = 3 * sizeof(uint64_t) + (7 + nb_covariance_values_) * sizeof(double);
+    trajectory_record_size_ = sizeof(uint64_t) + (7 + nb_covariance_values_) * sizeof(double);
+    transforms_offset_ = sizeof(header_);
+    trajectory_offset_ = transforms_offset_ + header_.nb_transforms * transform_record_size_;
+    loop_closures_offset_ = trajectory_offset_ + header_.nb_trajectory_poses * trajectory_record_size_;
+    const size_t expected_size = loop_closures_offset_ + header_.nb_loop_closures * 2 * sizeof(uint64_t);
+
+    is_valid_ = file_.size() == expected_size;
+}
+
+bool PoseGraphBinaryFile::isValid() const {
+    return is_valid_;
+}
+
+const PoseGraphBinaryHeader& PoseGraphBinaryFile::getHeader() const {
+    return header_;
+}
+
+const char* PoseGraphBinaryFile::transformRecord(const size_t& index) const {
+    return file_.data() + transforms_offset_ + index * transform_record_size_;
+}
+
+const char* PoseGraphBinaryFile::trajectoryRecord(const size_t& index) const {
+    return file_.data() + trajectory_offset_ + index * trajectory_record_size_;
+}
+
+Transform PoseGraphBinaryFile::getTransform(const size_t& index) const {
+    const char* record = transformRecord(index);
+    Transform transform;
+    transform.i = readUnsigned(record);
+    transform.j = readUnsigned(record + sizeof(uint64_t));
+    transform.is_loop_closure = readUnsigned(record + 2 * sizeof(uint64_t)) != 0;
+    readPoseWithCovariance(record + 3 * sizeof(uint64_t), header_.nb_degree_freedom, transform.pose);
+    return transform;
+}
+
+TrajectoryPose PoseGraphBinaryFile::getTrajectoryPose(const size_t& index) const {
+    const char* record = trajectoryRecord(index);
+    TrajectoryPose pose;
+    pose.id = readUnsigned(record);
+    readPoseWithCovariance(record + sizeof(uint64_t), header_.nb_degree_freedom, pose.pose);
+    return pose;
+}
+
+std::pair<size_t, size_t> PoseGraphBinaryFile::getLoopClosure(const size_t& index) const {
+    const char* record = file_.data() + loop_closures_offset_ + index * 2 * sizeof(uint64_t);
+    return std::make_pair(readUnsigned(record), readUnsigned(record + sizeof(uint64_t)));
+}
+
+uint8_t PoseGraphBinaryFile::load(size_t& num_poses, Transforms& transforms, LoopClosures& loop_closures) const {
+    num_poses = header_.num_poses;
+    transforms.start_id = header_.transforms_start_id;
+    transforms.end_id = header_.transforms_end_id;
+    transforms.transforms.reserve(transforms.transforms.size() + header_.nb_transforms);
+    for (size_t index = 0; index < header_.nb_transforms; index++) {
+        transforms.transforms.insert(getTransform(index));
+    }
+    loop_closures.reserve(loop_closures.size() + header_.nb_loop_closures);
+    for (size_t index = 0; index < header_.nb_loop_closures; index++) {
+        loop_closures.emplace_back(getLoopClosure(index));
+    }
+    return header_.nb_degree_freedom;
+}
+
+bool PoseGraphBinaryFile::loadTrajectory(Trajectory& trajectory) const {
+    if (header_.nb_trajectory_poses == 0) {
+        return false;
+    }
+    trajectory.start_id = header_.trajectory_start_id;
+    trajectory.end_id = header_.trajectory_end_id;
+    trajectory.trajectory_poses.clear();
+    trajectory.trajectory_poses.reserve(header_.nb_trajectory_poses);
+    for (size_t index = 0; index < header_.nb_trajectory_poses; index++) {
+        trajectory.trajectory_poses.push_back(getTrajectoryPose(index));
+        // The trajectory is dense, the poses must follow each other
+        if (trajectory.trajectory_poses.back().id != trajectory.start_id + index) {
+            trajectory.trajectory_poses.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,193 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "graph_utils/transform_store.h"
+#include "graph_utils/graph_types.h"
+
+#include <limits>
+#include <iostream>
+#include <cstdlib>
+
+namespace graph_utils {
+
+namespace {
+
+const uint32_t EMPTY_SLOT = std::numeric_limits<uint32_t>::max();
+
+const size_t MINIMUM_INDEX_SIZE = 16;
+
+inline size_t hashIds(const size_t& i, const size_t& j) {
+    // 64-bit mix of the two IDs (constants from splitmix64)
+    uint64_t h = static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t>(j);
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return h;
+}
+
+}
+
+const size_t TransformStore::NOT_FOUND = std::numeric_limits<size_t>::max();
+
+const size_t TransformStore::MAX_SIZE = EMPTY_SLOT;
+
+TransformStore::TransformStore(): index_(MINIMUM_INDEX_SIZE, EMPTY_SLOT) {}
+
+size_t TransformStore::size() const {
+    return i_.size();
+}
+
+bool TransformStore::empty() const {
+    return i_.empty();
+}
+
+void TransformStore::reserve(const size_t& capacity) {
+    if (capacity > MAX_SIZE) {
+        std::cerr << "Cannot store " << capacity << " transforms, the maximum is " << MAX_SIZE << std::endl;
+        std::abort();
+    }
+    i_.reserve(capacity);
+    j_.reserve(capacity);
+    is_loop_closure_.reserve(capacity);
+    poses_.reserve(capacity * 7);
+    covariances_.reserve(capacity * NB_COVARIANCE_VALUES);
+    while (index_.size() < 2 * capacity) {
+        growIndex();
+    }
+}
+
+void TransformStore::clear() {
+    i_.clear();
+    j_.clear();
+    is_loop_closure_.clear();
+    poses_.clear();
+    covariances_.clear();
+    index_.assign(MINIMUM_INDEX_SIZE, EMPTY_SLOT);
+}
+
+size_t TransformStore::findSlot(const size_t& i, const size_t& j) const {
+    // Linear probing, the table size is a power of two
+    const size_t mask = index_.size() - 1;
+    size_t slot = hashIds(i, j) & mask;
+    while (index_[slot] != EMPTY_SLOT && (i_[index_[slot]] != i || j_[index_[slot]] != j)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void TransformStore::growIndex() {
+    index_.assign(index_.size() * 2, EMPTY_SLOT);
+    for (size_t index = 0; index < i_.size(); index++) {
+        index_[findSlot(i_[index], j_[index])] = index;
+    }
+}
+
+bool TransformStore::insert(const Transform& transform) {
+    // The indexes of the hash table are 32-bit
+    if (i_.size() >= MAX_SIZE) {
+        std::cerr << "Cannot store more than " << MAX_SIZE << " transforms" << std::endl;
+        std::abort();
+    }
+    // Keep the load factor under 1/2
+    if (2 * (i_.size() + 1) > index_.size()) {
+        growIndex();
+    }
+    const size_t slot = findSlot(transform.i, transform.j);
+    if (index_[slot] != EMPTY_SLOT) {
+        return false;
+    }
+    index_[slot] = i_.size();
+
+    i_.push_back(transform.i);
+    j_.push_back(transform.j);
+    is_loop_closure_.push_back(transform.is_loop_closure);
+
+    const geometry_msgs::Pose& pose = transform.pose.pose;
+    poses_.resize(poses_.size() + 7);
+    double* p = &poses_[poses_.size() - 7];
+    p[0] = pose.position.x;
+    p[1] = pose.position.y;
+    p[2] = pose.position.z;
+    p[3] = pose.orientation.x;
+    p[4] = pose.orientation.y;
+    p[5] = pose.orientation.z;
+    p[6] = pose.orientation.w;
+
+    covariances_.resize(covariances_.size() + NB_COVARIANCE_VALUES);
+    double* c = &covariances_[covariances_.size() - NB_COVARIANCE_VALUES];
+    for (int row = 0; row < 6; row++) {
+        for (int col = row; col < 6; col++) {
+            *(c++) = transform.pose.covariance[row * 6 + col];
+        }
+    }
+    return true;
+}
+
+size_t TransformStore::find(const size_t& i, const size_t& j) const {
+    const uint32_t index = index_[findSlot(i, j)];
+    return index == EMPTY_SLOT ? NOT_FOUND : index;
+}
+
+size_t TransformStore::find(const std::pair<size_t, size_t>& ids) const {
+    return find(ids.first, ids.second);
+}
+
+Transform TransformStore::at(const size_t& index) const {
+    Transform transform;
+    transform.i = i_[index];
+    transform.j = j_[index];
+    transform.is_loop_closure = is_loop_closure_[index] != 0;
+    transform.pose = getPose(index);
+    return transform;
+}
+
+geometry_msgs::PoseWithCovariance TransformStore::getPose(const size_t& index) const {
+    geometry_msgs::PoseWithCovariance pose;
+    const double* p = getPoseData(index);
+    pose.pose.position.x = p[0];
+    pose.pose.position.y = p[1];
+    pose.pose.position.z = p[2];
+    pose.pose.orientation.x = p[3];
+    pose.pose.orientation.y = p[4];
+    pose.pose.orientation.z = p[5];
+    pose.pose.orientation.w = p[6];
+
+    const double* c = getCovarianceData(index);
+    for (int row = 0; row < 6; row++) {
+        for (int col = row; col < 6; col++) {
+            pose.covariance[row * 6 + col] = *c;
+            pose.covariance[col * 6 + row] = *c;
+            c++;
+        }
+    }
+    return pose;
+}
+
+const size_t& TransformStore::getI(const size_t& index) const {
+    return i_[index];
+}
+
+const size_t& TransformStore::getJ(const size_t& index) const {
+    return j_[index];
+}
+
+bool TransformStore::isLoopClosure(const size_t& index) const {
+    return is_loop_closure_[index] != 0;
+}
+
+const double* TransformStore::getPoseData(const size_t& index) const {
+    return poses_.data() + 7 * index;
+}
+
+const double* TransformStore::getCovarianceData(const size_t& index) const {
+    return covariances_.data() + NB_COVARIANCE_VALUES * index;
+}
+
+size_t TransformStore::getMemoryUsage() const {
+    return i_.capacity() * sizeof(size_t) + j_.capacity() * sizeof(size_t) +
+           is_loop_closure_.capacity() * sizeof(uint8_t) + poses_.capacity() * sizeof(double) +
+           covariances_.capacity() * sizeof(double) + index_.capacity() * sizeof(uint32_t);
+}
+
+}
@@ -0,0 +1,199 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "max_clique_solver/bitset_max_clique.h"
+
+#include <algorithm>
+
+namespace max_clique_solver {
+
+namespace {
+
+inline void resetBit(std::vector<uint64_t>& bitset, const int& vertex) {
+    bitset[vertex / 64] &= ~(uint64_t(1) << (vertex % 64));
+}
+
+}
+
+BitsetMaxClique::BitsetMaxClique(FMC::CGraphIO& gio): degeneracy_(0), max_clique_size_(0), nb_expanded_nodes_(0) {
+    const std::vector<int>& vertices = *gio.GetVerticesPtr();
+    const std::vector<int>& edges = *gio.GetEdgesPtr();
+    nb_vertices_ = vertices.empty() ? 0 : vertices.size() - 1;
+    nb_words_ = (nb_vertices_ + 63) / 64;
+    orderVertices(vertices, edges);
+
+    std::vector<int> new_vertices(nb_vertices_);
+    for (size_t vertex = 0; vertex < nb_vertices_; vertex++) {
+        new_vertices[original_vertices_[vertex]] = vertex;
+    }
+    adjacency_.assign(nb_vertices_ * nb_words_, 0);
+    for (size_t vertex = 0; vertex < nb_vertices_; vertex++) {
+        uint64_t* neighbors = &adjacency_[new_vertices[vertex] * nb_words_];
+        for (int edge = vertices[vertex]; edge < vertices[vertex + 1]; edge++) {
+            const int neighbor = new_vertices[edges[edge]];
+            neighbors[neighbor / 64] |= uint64_t(1) << (neighbor % 64);
+        }
+    }
+}
+
+void BitsetMaxClique::orderVertices(const std::vector<int>& vertices, const std::vector<int>& edges) {
+    // Vertices sorted by degree in buckets, the degrees decrease as the vertices are removed
+    std::vector<int> degrees(nb_vertices_);
+    int max_degree = 0;
+    for (size_t vertex = 0; vertex < nb_vertices_; vertex++) {
+        degrees[vertex] = vertices[vertex + 1] - vertices[vertex];
+        max_degree = std::max(max_degree, degrees[vertex]);
+    }
+    std::vector<int> bucket_starts(max_degree + 2, 0);
+    for (size_t vertex = 0; vertex < nb_vertices_; vertex++) {
+        bucket_starts[degrees[vertex] + 1]++;
+    }
+    for (int degree = 0; degree <= max_degree; degree++) {
+        bucket_starts[degree + 1] += bucket_starts[degree];
+    }
+    std::vector<int> sorted_vertices(nb_vertices_), positions(nb_vertices_);
+    for (size_t vertex = 0; vertex < nb_vertices_; vertex++) {
+        positions[vertex] = bucket_starts[degrees[vertex]]++;
+        sorted_vertices[positions[vertex]] = vertex;
+    }
+    for (int degree = max_degree; degree > 0; degree--) {
+        bucket_starts[degree] = bucket_starts[degree - 1];
+    }
+    bucket_starts[0] = 0;
+
+    // Removal of the vertex of minimum degree : its neighbors of larger degree move to the bucket below
+    degeneracy_ = 0;
+    for (size_t index = 0; index < nb_vertices_; index++) {
+        const int vertex = sorted_vertices[index];
+        degeneracy_ = std::max(degeneracy_, degrees[vertex]);
+        for (int edge = vertices[vertex]; edge < vertices[vertex + 1]; edge++) {
+            const int neighbor = edges[edge];
+            if (degrees[neighbor] > degrees[vertex]) {
+                const int first = sorted_vertices[bucket_starts[degrees[neighbor]]];
+                if (first != neighbor) {
+                    std::swap(sorted_vertices[positions[neighbor]], sorted_vertices[bucket_starts[degrees[neighbor]]]);
+                    std::swap(positions[neighbor], positions[first]);
+                }
+                bucket_starts[degrees[neighbor]]++;
+                degrees[neighbor]--;
+            }
+        }
+    }
+
+    // The first vertex removed is the last one
+    original_vertices_.assign(sorted_vertices.rbegin(), sorted_vertices.rend());
+}
+
+int BitsetMaxClique::findMaxClique(const int& lower_bound, std::vector<int>& max_clique) {
+    clique_.clear();
+    max_clique_.clear();
+    max_clique_size_ = lower_bound;
+    nb_expanded_nodes_ = 0;
+
+    // One buffer per depth, allocated beforehand since the expansion keeps references to them
+    const size_t max_depth = std::min<size_t>(degeneracy_, nb_vertices_) + 2;
+    candidates_.assign(max_depth, std::vector<uint64_t>(nb_words_));
+    colored_vertices_.resize(max_depth);
+    colors_.resize(max_depth);
+    uncolored_.resize(nb_words_);
+    color_class_.resize(nb_words_);
+
+    // The degeneracy bounds the size of the cliques
+    if (nb_vertices_ > 0 && getUpperBound() > lower_bound) {
+        std::fill(candidates_[0].begin(), candidates_[0].end(), ~uint64_t(0));
+        if (nb_vertices_ % 64 != 0) {
+            candidates_[0].back() = (uint64_t(1) << (nb_vertices_ % 64)) - 1;
+        }
+        expand(0);
+    }
+
+    max_clique.clear();
+    for (const int& vertex: max_clique_) {
+        max_clique.push_back(original_vertices_[vertex]);
+    }
+    std::sort(max_clique.begin(), max_clique.end());
+    return max_clique_size_;
+}
+
+size_t BitsetMaxClique::getNbExpandedNodes() const {
+    return nb_expanded_nodes_;
+}
+
+int BitsetMaxClique::getUpperBound() const {
+    return degeneracy_ + 1;
+}
+
+void BitsetMaxClique::expand(const size_t& depth) {
+    nb_expanded_nodes_++;
+    colorCandidates(depth);
+    std::vector<uint64_t>& candidates = candidates_[depth];
+    std::vector<uint64_t>& new_candidates = candidates_[depth + 1];
+    const std::vector<int>& colored_vertices = colored_vertices_[depth];
+    const std::vector<int>& colors = colors_[depth];
+
+    for (size_t index = colored_vertices.size(); index-- > 0;) {
+        // The remaining candidates have at most colors[index] colors, each adding a vertex at most
+        if (int(clique_.size()) + colors[index] <= max_clique_size_) {
+            return;
+        }
+        const int vertex = colored_vertices[index];
+        const uint64_t* neighbors = &adjacency_[vertex * nb_words_];
+        bool is_empty = true;
+        for (size_t word = 0; word < nb_words_; word++) {
+            new_candidates[word] = candidates[word] & neighbors[word];
+            is_empty &= new_candidates[word] == 0;
+        }
+        clique_.push_back(vertex);
+        if (is_empty) {
+            if (int(clique_.size()) > max_clique_size_) {
+                max_clique_size_ = clique_.size();
+                max_clique_ = clique_;
+            }
+        } else {
+            expand(depth + 1);
+        }
+        clique_.pop_back();
+        resetBit(candidates, vertex);
+    }
+}
+
+void BitsetMaxClique::colorCandidates(const size_t& depth) {
+    std::vector<int>& colored_vertices = colored_vertices_[depth];
+    std::vector<int>& colors = colors_[depth];
+    colored_vertices.clear();
+    colors.clear();
+
+    // Colors too small to beat the best clique are not listed, but their vertices are colored
+    const int min_color = max_clique_size_ - int(clique_.size()) + 1;
+    size_t nb_uncolored = 0;
+    for (size_t word = 0; word < nb_words_; word++) {
+        uncolored_[word] = candidates_[depth][word];
+        nb_uncolored += __builtin_popcountll(uncolored_[word]);
+    }
+    for (int color = 1; nb_uncolored > 0; color++) {
+        // Color class : each uncolored vertex in order that is not adjacent to the previous ones
+        color_class_ = uncolored_;
+        for (size_t word = 0; word < nb_words_; word++) {
+            while (color_class_[word] != 0) {
+                const int vertex = word * 64 + __builtin_ctzll(color_class_[word]);
+                const uint64_t* neighbors = &adjacency_[vertex * nb_words_];
+                resetBit(color_class_, vertex);
+                for (size_t next_word = word; next_word < nb_words_; next_word++) {
+                    color_class_[next_word] &= ~neighbors[next_word];
+                }
+                resetBit(uncolored_, vertex);
+                nb_uncolored--;
+                if (color >= min_color) {
+                    colored_vertices.push_back(vertex);
+                    colors.push_back(color);
+                }
+            }
+        }
+    }
+}
+
+int maxCliqueBitset(FMC::CGraphIO& gio, int l_bound, std::vector<int>& max_clique_data) {
+    BitsetMaxClique search(gio);
+    return search.findMaxClique(l_bound, max_clique_data);
+}
+
+}
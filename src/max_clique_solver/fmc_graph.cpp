@@ -0,0 +1,42 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "max_clique_solver/fmc_graph.h"
+
+namespace max_clique_solver {
+
+void loadConsistencyGraph(const graph_utils::ConsistencyGraph& consistency_graph, FMC::CGraphIO& gio) {
+    // Same layout, only the integer types differ
+    std::vector<int> vertices(consistency_graph.getOffsets().begin(), consistency_graph.getOffsets().end());
+    std::vector<int> edges(consistency_graph.getNeighbors().begin(), consistency_graph.getNeighbors().end());
+    if (vertices.empty()) {
+        vertices.push_back(0);
+    }
+    gio.SetAdjacencyGraph(vertices, edges);
+}
+
+void loadConsistencyGraph(const graph_utils::PackedConsistencyMatrix& consistency_matrix, FMC::CGraphIO& gio) {
+    const size_t nb_vertices = consistency_matrix.getNbVertices();
+    const std::vector<size_t> degrees = consistency_matrix.computeDegrees();
+    std::vector<int> vertices(nb_vertices + 1, 0);
+    for (size_t u = 0; u < nb_vertices; u++) {
+        vertices[u + 1] = vertices[u] + degrees[u];
+    }
+
+    // Rows in increasing order : the neighbors w < v of a vertex v are appended by their own rows,
+    // before the row of v appends its neighbors w > v, so the neighbors end up sorted
+    std::vector<int> edges(vertices.back());
+    std::vector<int> ends(vertices.begin(), vertices.end() - 1);
+    for (size_t u = 0; u < nb_vertices; u++) {
+        const graph_utils::PackedConsistencyMatrix::RowView row = consistency_matrix.getRow(u);
+        for (size_t column = row.getFirstColumn(); column < row.getEndColumn(); column += 64) {
+            for (uint64_t word = row.getWord(column); word != 0; word &= word - 1) {
+                const size_t v = column + __builtin_ctzll(word);
+                edges[ends[u]++] = v;
+                edges[ends[v]++] = u;
+            }
+        }
+    }
+    gio.SetAdjacencyGraph(vertices, edges);
+}
+
+}
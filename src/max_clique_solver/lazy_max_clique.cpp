@@ -0,0 +1,91 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "max_clique_solver/lazy_max_clique.h"
+
+namespace max_clique_solver {
+
+LazyMaxClique::LazyMaxClique(const size_t& nb_vertices, const AdjacencyOracle& is_adjacent):
+    nb_vertices_(nb_vertices), is_adjacent_(is_adjacent), max_clique_size_(0), nb_expanded_nodes_(0) {}
+
+size_t LazyMaxClique::findMaxClique(const size_t& lower_bound, std::vector<uint32_t>& max_clique) {
+    clique_.clear();
+    max_clique_.clear();
+    max_clique_size_ = lower_bound;
+    suffix_bounds_.assign(nb_vertices_, 0);
+    nb_expanded_nodes_ = 0;
+
+    std::vector<uint32_t> vertices(nb_vertices_), candidates;
+    for (size_t vertex = 0; vertex < nb_vertices_; vertex++) {
+        vertices[vertex] = vertex;
+    }
+
+    // Maximum clique of the vertices from v to the last one, for v from the last vertex to the first one
+    for (size_t vertex = nb_vertices_; vertex-- > 0;) {
+        if (buildCandidates(vertex, vertices.data() + vertex + 1, vertices.data() + nb_vertices_, candidates)) {
+            clique_.push_back(vertex);
+            expand(candidates);
+            clique_.pop_back();
+        }
+        suffix_bounds_[vertex] = max_clique_size_;
+    }
+
+    max_clique = max_clique_;
+    return max_clique_size_;
+}
+
+size_t LazyMaxClique::getNbExpandedNodes() const {
+    return nb_expanded_nodes_;
+}
+
+bool LazyMaxClique::expand(const std::vector<uint32_t>& candidates) {
+    nb_expanded_nodes_++;
+    if (candidates.empty()) {
+        if (clique_.size() > max_clique_size_) {
+            max_clique_size_ = clique_.size();
+            max_clique_ = clique_;
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<uint32_t> new_candidates;
+    for (size_t index = 0; index < candidates.size(); index++) {
+        // Even with all the remaining candidates, or with the maximum clique of the vertices from
+        // the candidate to the last one, the clique would not be larger than the best one
+        if (clique_.size() + candidates.size() - index <= max_clique_size_ ||
+            clique_.size() + suffix_bounds_[candidates[index]] <= max_clique_size_) {
+            return false;
+        }
+        if (buildCandidates(candidates[index], candidates.data() + index + 1, candidates.data() + candidates.size(), new_candidates)) {
+            clique_.push_back(candidates[index]);
+            const bool is_found = expand(new_candidates);
+            clique_.pop_back();
+            // The vertex being added at the first level increases the maximum clique by one at most
+            if (is_found) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool LazyMaxClique::buildCandidates(const uint32_t& vertex, const uint32_t* begin, const uint32_t* end, std::vector<uint32_t>& new_candidates) {
+    new_candidates.clear();
+    for (const uint32_t* candidate = begin; candidate != end; candidate++) {
+        // The branch contains the current clique, the vertex and at most the adjacent candidates not yet queried
+        if (clique_.size() + 1 + new_candidates.size() + (end - candidate) <= max_clique_size_) {
+            return false;
+        }
+        // The first candidate of the branch bounds it by its maximum clique of the next vertices, which
+        // decreases along the candidates : past this point, no candidate can start a larger clique
+        if (new_candidates.empty() && clique_.size() + 1 + suffix_bounds_[*candidate] <= max_clique_size_) {
+            return false;
+        }
+        if (is_adjacent_(vertex, *candidate)) {
+            new_candidates.push_back(*candidate);
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,277 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "max_clique_solver/parallel_max_clique.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace max_clique_solver {
+
+const size_t ParallelMaxClique::MAX_SPLIT_DEPTH;
+const size_t ParallelMaxClique::MIN_SPLIT_CANDIDATES;
+
+ParallelMaxClique::ParallelMaxClique(FMC::CGraphIO& gio, const size_t& nb_threads):
+    vertices_(*gio.GetVerticesPtr()), edges_(*gio.GetEdgesPtr()),
+    nb_threads_(nb_threads > 0 ? nb_threads : std::max<size_t>(1, std::thread::hardware_concurrency())),
+    best_size_(0), best_version_(0), nb_pending_tasks_(0), nb_idle_workers_(0) {
+    workers_.reserve(nb_threads_);
+    for (size_t worker = 0; worker < nb_threads_; worker++) {
+        workers_.emplace_back(new Worker());
+    }
+}
+
+int ParallelMaxClique::findMaxClique(const int& lower_bound, std::vector<int>& max_clique) {
+    const int nb_vertices = vertices_.empty() ? 0 : vertices_.size() - 1;
+    int max_degree = 0;
+    for (int vertex = 0; vertex < nb_vertices; vertex++) {
+        max_degree = std::max(max_degree, getDegree(vertex));
+    }
+
+    best_.size = lower_bound;
+    best_.clique.clear();
+    best_size_ = lower_bound;
+    best_version_ = 0;
+    for (auto& worker: workers_) {
+        worker->tasks.clear();
+        worker->clique.clear();
+        // One buffer per depth, allocated beforehand since the expansion keeps references to them
+        worker->candidates.resize(max_degree + 2);
+        worker->is_neighbor.assign(nb_vertices, 0);
+        worker->best = best_;
+        worker->best_version = 0;
+        worker->nb_expanded_nodes = 0;
+        worker->nb_stolen_tasks = 0;
+        worker->nb_split_tasks = 0;
+    }
+
+    // Root vertices in the order of FMC::maxClique, dealt so that each thread starts with its last vertex
+    for (int vertex = 0; vertex < nb_vertices; vertex++) {
+        Task task;
+        task.clique.assign(1, vertex);
+        task.is_root = true;
+        workers_[(nb_vertices - 1 - vertex) % nb_threads_]->tasks.push_back(std::move(task));
+    }
+    nb_pending_tasks_ = nb_vertices;
+    nb_idle_workers_ = 0;
+
+    std::vector<std::thread> threads;
+    for (size_t worker = 1; worker < nb_threads_; worker++) {
+        threads.emplace_back(&ParallelMaxClique::work, this, worker);
+    }
+    work(0);
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    max_clique.assign(best_.clique.rbegin(), best_.clique.rend());
+    return best_.size;
+}
+
+size_t ParallelMaxClique::getNbExpandedNodes() const {
+    size_t result = 0;
+    for (const auto& worker: workers_) {
+        result += worker->nb_expanded_nodes;
+    }
+    return result;
+}
+
+size_t ParallelMaxClique::getNbStolenTasks() const {
+    size_t result = 0;
+    for (const auto& worker: workers_) {
+        result += worker->nb_stolen_tasks;
+    }
+    return result;
+}
+
+size_t ParallelMaxClique::getNbSplitTasks() const {
+    size_t result = 0;
+    for (const auto& worker: workers_) {
+        result += worker->nb_split_tasks;
+    }
+    return result;
+}
+
+void ParallelMaxClique::work(const size_t& worker_index) {
+    Worker& worker = *workers_[worker_index];
+    Task task;
+    bool is_idle = false;
+    while (true) {
+        if (takeTask(worker_index, task)) {
+            if (is_idle) {
+                nb_idle_workers_--;
+                is_idle = false;
+            }
+            runTask(worker, task);
+            nb_pending_tasks_--;
+        } else if (nb_pending_tasks_ == 0) {
+            break;
+        } else {
+            // The remaining tasks are being run, and may be split
+            if (!is_idle) {
+                nb_idle_workers_++;
+                is_idle = true;
+            }
+            std::this_thread::yield();
+        }
+    }
+    if (is_idle) {
+        nb_idle_workers_--;
+    }
+}
+
+bool ParallelMaxClique::takeTask(const size_t& worker_index, Task& task) {
+    Worker& worker = *workers_[worker_index];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < nb_threads_; offset++) {
+        Worker& victim = *workers_[(worker_index + offset) % nb_threads_];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            worker.nb_stolen_tasks++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ParallelMaxClique::runTask(Worker& worker, Task& task) {
+    std::vector<int>& candidates = worker.candidates[0];
+    if (task.is_root) {
+        // Pruning 1 of FMC : the degree of the root bounds the size of its cliques
+        const int root = task.clique.front();
+        worker.clique.clear();
+        if (!canImprove(worker, root, getDegree(root) + 1)) {
+            return;
+        }
+        // Neighbors of lower index, which can be part of a clique as large as the best one (pruning 2 and 3)
+        const int min_degree = best_size_ - 1;
+        candidates.clear();
+        for (int edge = vertices_[root]; edge < vertices_[root + 1]; edge++) {
+            if (edges_[edge] < root && getDegree(edges_[edge]) >= min_degree) {
+                candidates.push_back(edges_[edge]);
+            }
+        }
+        if (!std::is_sorted(candidates.begin(), candidates.end())) {
+            std::sort(candidates.begin(), candidates.end());
+        }
+        worker.clique.push_back(root);
+    } else {
+        worker.clique = std::move(task.clique);
+        candidates = std::move(task.candidates);
+    }
+    expand(worker, 0);
+}
+
+void ParallelMaxClique::expand(Worker& worker, const size_t& depth) {
+    worker.nb_expanded_nodes++;
+    const std::vector<int>& candidates = worker.candidates[depth];
+    std::vector<int>& new_candidates = worker.candidates[depth + 1];
+    if (candidates.empty()) {
+        submitClique(worker);
+        return;
+    }
+
+    size_t first = 0;
+    for (size_t index = candidates.size(); index-- > first;) {
+        // Even with all the remaining candidates, the clique would not be better than the best one
+        if (!canImprove(worker, candidates[index], worker.clique.size() + index + 1)) {
+            return;
+        }
+        // Hands the first half of the remaining candidates over to the idle threads, as a branch with the
+        // same clique : each of these candidates keeps the ones before it as candidates. Once per branch,
+        // since the candidates handed over are the ones before all the others.
+        if (first == 0 && nb_idle_workers_ > 0 && worker.clique.size() <= MAX_SPLIT_DEPTH && index >= MIN_SPLIT_CANDIDATES) {
+            const size_t middle = index / 2;
+            Task task;
+            task.clique = worker.clique;
+            task.candidates.assign(candidates.begin(), candidates.begin() + middle);
+            task.is_root = false;
+            nb_pending_tasks_++;
+            {
+                std::lock_guard<std::mutex> lock(worker.mutex);
+                worker.tasks.push_front(std::move(task));
+            }
+            worker.nb_split_tasks++;
+            first = middle;
+        }
+        intersect(worker, candidates[index], candidates, index, new_candidates);
+        worker.clique.push_back(candidates[index]);
+        expand(worker, depth + 1);
+        worker.clique.pop_back();
+    }
+}
+
+void ParallelMaxClique::intersect(Worker& worker, const int& vertex, const std::vector<int>& candidates, const size_t& nb_candidates,
+                                  std::vector<int>& new_candidates) {
+    // Pruning 5 of FMC, for the cliques as large as the best one
+    const int min_degree = best_size_ - 1;
+    new_candidates.clear();
+    for (int edge = vertices_[vertex]; edge < vertices_[vertex + 1]; edge++) {
+        worker.is_neighbor[edges_[edge]] = 1;
+    }
+    for (size_t index = 0; index < nb_candidates; index++) {
+        if (worker.is_neighbor[candidates[index]] && getDegree(candidates[index]) >= min_degree) {
+            new_candidates.push_back(candidates[index]);
+        }
+    }
+    for (int edge = vertices_[vertex]; edge < vertices_[vertex + 1]; edge++) {
+        worker.is_neighbor[edges_[edge]] = 0;
+    }
+}
+
+bool ParallelMaxClique::canImprove(Worker& worker, const int& next, const size_t& max_size) {
+    if (int(max_size) != best_size_) {
+        return int(max_size) > best_size_;
+    }
+    // The branch can only reach the size of the best clique : it is expanded if its clique comes first in the search order
+    refreshBest(worker);
+    if (int(max_size) != worker.best.size) {
+        return int(max_size) > worker.best.size;
+    }
+    const std::vector<int>& best = worker.best.clique;
+    if (best.empty()) {
+        return false;
+    }
+    for (size_t index = 0; index < worker.clique.size(); index++) {
+        if (worker.clique[index] != best[index]) {
+            return worker.clique[index] > best[index];
+        }
+    }
+    return next >= best[worker.clique.size()];
+}
+
+void ParallelMaxClique::submitClique(Worker& worker) {
+    if (int(worker.clique.size()) < best_size_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(best_mutex_);
+    if (int(worker.clique.size()) > best_.size || (int(worker.clique.size()) == best_.size && !best_.clique.empty() &&
+        std::lexicographical_compare(best_.clique.begin(), best_.clique.end(), worker.clique.begin(), worker.clique.end()))) {
+        best_.size = worker.clique.size();
+        best_.clique = worker.clique;
+        best_size_ = best_.size;
+        best_version_++;
+    }
+}
+
+void ParallelMaxClique::refreshBest(Worker& worker) {
+    if (best_version_ != worker.best_version) {
+        std::lock_guard<std::mutex> lock(best_mutex_);
+        worker.best = best_;
+        worker.best_version = best_version_;
+    }
+}
+
+int ParallelMaxClique::getDegree(const int& vertex) const {
+    return vertices_[vertex + 1] - vertices_[vertex];
+}
+
+}
@@ -0,0 +1,60 @@
+// Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
+
+#include "pairwise_consistency/consistency_oracle.h"
+
+#include <algorithm>
+
+namespace pairwise_consistency {
+
+namespace {
+
+const size_t WORD_SIZE = 64;
+const uint64_t EVALUATED = 1, CONSISTENT = 2;
+
+}
+
+ConsistencyOracle::ConsistencyOracle(const PairwiseConsistency& pairwise_consistency):
+    pairwise_consistency_(pairwise_consistency), nb_vertices_(pairwise_consistency.getLoopClosures().size()),
+    states_((nb_vertices_ * (nb_vertices_ - std::min<size_t>(nb_vertices_, 1)) + WORD_SIZE - 1) / WORD_SIZE, 0),
+    nb_queries_(0), nb_evaluations_(0) {}
+
+bool ConsistencyOracle::isConsistent(const size_t& u, const size_t& v) {
+    if (u == v) {
+        return false;
+    }
+    nb_queries_.fetch_add(1, std::memory_order_relaxed);
+
+    // Rows 0 to u-1 of the strict upper triangle hold (m-1) + (m-2) + ... + (m-u) pairs
+    const size_t row = std::min(u, v), column = std::max(u, v);
+    const size_t bit = 2 * (row * (2 * nb_vertices_ - row - 1) / 2 + column - row - 1);
+    uint64_t* word = &states_[bit / WORD_SIZE];
+    const size_t shift = bit % WORD_SIZE;
+    const uint64_t state = (__atomic_load_n(word, __ATOMIC_RELAXED) >> shift) & (EVALUATED | CONSISTENT);
+    if (state & EVALUATED) {
+        return state & CONSISTENT;
+    }
+
+    ConsistencyStatistics statistics;
+    const bool is_consistent = pairwise_consistency_.evaluatePair(row, column, statistics);
+    nb_evaluations_.fetch_add(1, std::memory_order_relaxed);
+    __atomic_fetch_or(word, (EVALUATED | (is_consistent ? CONSISTENT : 0)) << shift, __ATOMIC_RELAXED);
+    return is_consistent;
+}
+
+size_t ConsistencyOracle::getNbVertices() const {
+    return nb_vertices_;
+}
+
+size_t ConsistencyOracle::getNbQueries() const {
+    return nb_queries_.load();
+}
+
+size_t ConsistencyOracle::getNbEvaluations() const {
+    return nb_evaluations_.load();
+}
+
+size_t ConsistencyOracle::getMemoryUsage() const {
+    return states_.capacity() * sizeof(uint64_t);
+}
+
+}
@@ -1,125 +1,500 @@
 // Copyright (C) 2018 by Pierre-Yves Lajoie <lajoie.py@gmail.com>
 
 #include "pairwise_consistency/pairwise_consistency.h"
+#include "graph_utils/information_form.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 namespace pairwise_consistency {
 
+namespace {
+
+inline Eigen::Isometry2d getTransformation(const graph_utils::PoseSE2& pose) {
+    return Eigen::Translation2d(pose.mean(0), pose.mean(1)) * Eigen::Rotation2Dd(pose.mean(2));
+}
+
+inline Eigen::Isometry3d getTransformation(const graph_utils::PoseSE3& pose) {
+    Eigen::Isometry3d result = Eigen::Isometry3d::Identity();
+    result.linear() = pose.rotation;
+    result.translation() = pose.translation;
+    return result;
+}
+
+inline StandardDeviations getStandardDeviations(const graph_utils::PoseSE2& pose) {
+    StandardDeviations result;
+    result.translation = std::sqrt(pose.covariance(0,0) + pose.covariance(1,1));
+    result.angles = std::sqrt(pose.covariance(2,2));
+    return result;
+}
+
+inline StandardDeviations getStandardDeviations(const graph_utils::PoseSE3& pose) {
+    StandardDeviations result;
+    result.translation = std::sqrt(pose.covariance.topLeftCorner<3,3>().trace());
+    result.angles = std::sqrt(pose.covariance.bottomRightCorner<3,3>().trace());
+    return result;
+}
+
+}
+
+PairwiseConsistency::PairwiseConsistency(const graph_utils::Transforms& transforms_robot1,
+                                         const graph_utils::Transforms& transforms_robot2,
+                                         const graph_utils::Transforms& transforms_interrobot,
+                                         const graph_utils::LoopClosures& loop_closures,
+                                         const graph_utils::Trajectory& trajectory_robot1,
+                                         const graph_utils::Trajectory& trajectory_robot2,
+                                         uint8_t nb_degree_freedom,
+                                         const size_t& nb_threads,
+                                         const bool& use_early_rejection,
+                                         const bool& use_odometry_relative_poses):
+                                         loop_closures_(loop_closures), transforms_robot1_(transforms_robot1),
+                                         transforms_robot2_(transforms_robot2), transforms_interrobot_(transforms_interrobot),
+                                         trajectory_robot1_(trajectory_robot1), trajectory_robot2_(trajectory_robot2),
+                                         nb_degree_freedom_(nb_degree_freedom), nb_threads_(nb_threads),
+                                         use_early_rejection_(use_early_rejection),
+                                         use_odometry_relative_poses_(use_odometry_relative_poses) {
+    if (nb_threads_ == 0) {
+        nb_threads_ = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    if (nb_degree_freedom_ == 3) {
+        buildLoopClosureTable(poses_se2_);
+    } else {
+        buildLoopClosureTable(poses_se3_);
+    }
+}
+
+template <typename Pose>
+void PairwiseConsistency::buildLoopClosureTable(ConsistencyPoses<Pose>& poses) {
+    const graph_utils::Trajectory* trajectories[2] = {&trajectory_robot1_, &trajectory_robot2_};
+    for (int robot = 0; robot < 2; robot++) {
+        const auto& trajectory_poses = trajectories[robot]->trajectory_poses;
+        poses.trajectories[robot].resize(trajectory_poses.size());
+        for (size_t index = 0; index < trajectory_poses.size(); index++) {
+            graph_utils::fromPoseWithCovariance(trajectory_poses[index].pose, poses.trajectories[robot][index]);
+        }
+    }
+
+    if (use_odometry_relative_poses_) {
+        poses.odometries[0] = graph_utils::OdometryTree<Pose>(transforms_robot1_);
+        poses.odometries[1] = graph_utils::OdometryTree<Pose>(transforms_robot2_);
+    }
+
+    if (use_early_rejection_) {
+        buildRejectionBounds(poses);
+    }
+
+    extendLoopClosureTable(poses, 0);
+}
+
+template <typename Pose>
+void PairwiseConsistency::extendLoopClosureTable(ConsistencyPoses<Pose>& poses, const size_t& first_loop_closure) {
+    const graph_utils::Trajectory* trajectories[2] = {&trajectory_robot1_, &trajectory_robot2_};
+    const auto& transforms = transforms_interrobot_.transforms;
+    poses.loop_closure_entries.resize(loop_closures_.size());
+    poses.loop_closures.resize(loop_closures_.size());
+    for (int robot = 0; robot < 2; robot++) {
+        poses.row_terms[robot].resize(loop_closures_.size());
+        poses.column_terms[robot].resize(loop_closures_.size());
+        poses.loop_transformations[robot].resize(loop_closures_.size());
+    }
+    for (size_t index = first_loop_closure; index < loop_closures_.size(); index++) {
+        const size_t i = loop_closures_[index].first, k = loop_closures_[index].second;
+        LoopClosureEntry& entry = poses.loop_closure_entries[index];
+        entry.orientations = 0;
+        if (graph_utils::isInTrajectory(trajectory_robot1_, i) && graph_utils::isInTrajectory(trajectory_robot2_, k)) {
+            entry.orientations |= LoopClosureEntry::ROBOT1_TO_ROBOT2;
+        }
+        if (graph_utils::isInTrajectory(trajectory_robot2_, i) && graph_utils::isInTrajectory(trajectory_robot1_, k)) {
+            entry.orientations |= LoopClosureEntry::ROBOT2_TO_ROBOT1;
+        }
+        for (int robot = 0; robot < 2; robot++) {
+            entry.first_indexes[robot] = i - trajectories[robot]->start_id;
+            entry.second_indexes[robot] = k - trajectories[robot]->start_id;
+        }
+        graph_utils::fromPoseWithCovariance(transforms.getPose(transforms.find(loop_closures_[index])), poses.loop_closures[index]);
+        if (entry.orientations & LoopClosureEntry::ROBOT1_TO_ROBOT2) {
+            computeLoopTerms(poses, index, 0);
+        }
+        if (entry.orientations & LoopClosureEntry::ROBOT2_TO_ROBOT1) {
+            computeLoopTerms(poses, index, 1);
+        }
+    }
+
+    if (use_early_rejection_) {
+        rejection_bounds_.loop_closure_deviations.resize(loop_closures_.size());
+        for (size_t index = first_loop_closure; index < loop_closures_.size(); index++) {
+            rejection_bounds_.loop_closure_deviations[index] = getStandardDeviations(poses.loop_closures[index]);
+        }
+    }
+}
+
+template <typename Pose>
+void PairwiseConsistency::buildRejectionBounds(const ConsistencyPoses<Pose>& poses) {
+    for (int robot = 0; robot < 2; robot++) {
+        const auto& trajectory_poses = poses.trajectories[robot];
+        rejection_bounds_.deviations[robot].resize(trajectory_poses.size());
+        for (size_t index = 0; index < trajectory_poses.size(); index++) {
+            rejection_bounds_.deviations[robot][index] = getStandardDeviations(trajectory_poses[index]);
+        }
+    }
+    // In 3D, the rates of the angles are mapped to the angular velocity by 3 unit vectors
+    rejection_bounds_.angle_factor = graph_utils::PoseTraits<Pose>::DIMENSION == 3 ? 1 : std::sqrt(3.0);
+}
+
+void PairwiseConsistency::addLoopClosures(const graph_utils::LoopClosures& loop_closures, const graph_utils::Transforms& transforms_interrobot) {
+    // Measurements of the new loop closures
+    for (size_t index = 0; index < transforms_interrobot.transforms.size(); index++) {
+        transforms_interrobot_.transforms.insert(transforms_interrobot.transforms.at(index));
+    }
+    const size_t first_loop_closure = loop_closures_.size();
+    loop_closures_.insert(loop_closures_.end(), loop_closures.begin(), loop_closures.end());
+
+    // Only the new rows are evaluated
+    if (nb_degree_freedom_ == 3) {
+        extendLoopClosureTable(poses_se2_, first_loop_closure);
+        updateConsistencyGraph(poses_se2_);
+    } else {
+        extendLoopClosureTable(poses_se3_, first_loop_closure);
+        updateConsistencyGraph(poses_se3_);
+    }
+}
+
+const graph_utils::DynamicConsistencyGraph& PairwiseConsistency::updateConsistencyGraph() {
+    if (nb_degree_freedom_ == 3) {
+        updateConsistencyGraph(poses_se2_);
+    } else {
+        updateConsistencyGraph(poses_se3_);
+    }
+    return consistency_graph_;
+}
+
+template <typename Pose>
+void PairwiseConsistency::updateConsistencyGraph(const ConsistencyPoses<Pose>& poses) {
+    // Pairs (u, v), u < v, of which v is not yet a vertex of the graph
+    const size_t first_new_vertex = consistency_graph_.getNbVertices();
+    std::vector<graph_utils::ConsistencyGraph::Edges> edge_buffers(nb_threads_);
+    forEachConsistentPair(poses, first_new_vertex, getChiSquaredThreshold(), [&](const size_t& thread, const size_t& u, const size_t& v, const double&) {
+        edge_buffers[thread].emplace_back(u, v);
+    });
+    consistency_graph_.addVertices(loop_closures_.size() - first_new_vertex, edge_buffers);
+}
+
 Eigen::MatrixXi PairwiseConsistency::computeConsistentMeasurementsMatrix() {
+    if (nb_degree_freedom_ == 3) {
+        return computeConsistencyMatrix(poses_se2_);
+    } else {
+        return computeConsistencyMatrix(poses_se3_);
+    }
+}
+
+graph_utils::ConsistencyGraph PairwiseConsistency::computeConsistencyGraph() {
+    if (nb_degree_freedom_ == 3) {
+        return computeConsistencyGraph(poses_se2_);
+    } else {
+        return computeConsistencyGraph(poses_se3_);
+    }
+}
+
+graph_utils::PackedConsistencyMatrix PairwiseConsistency::computePackedConsistencyMatrix() {
+    if (nb_degree_freedom_ == 3) {
+        return computePackedConsistencyMatrix(poses_se2_);
+    } else {
+        return computePackedConsistencyMatrix(poses_se3_);
+    }
+}
+
+graph_utils::ConsistencyDistances PairwiseConsistency::computeConsistencyDistances(const double& max_threshold) {
+    if (nb_degree_freedom_ == 3) {
+        return computeConsistencyDistances(poses_se2_, max_threshold);
+    } else {
+        return computeConsistencyDistances(poses_se3_, max_threshold);
+    }
+}
+
+bool PairwiseConsistency::evaluatePair(const size_t& u, const size_t& v, ConsistencyStatistics& statistics) const {
+    const double threshold = getChiSquaredThreshold();
+    double distance;
+    bool is_consistent;
+    statistics.nb_pairs++;
+    if (nb_degree_freedom_ == 3) {
+        is_consistent = computePairSquaredDistance(poses_se2_, std::min(u, v), std::max(u, v), threshold, distance, statistics);
+    } else {
+        is_consistent = computePairSquaredDistance(poses_se3_, std::min(u, v), std::max(u, v), threshold, distance, statistics);
+    }
+    is_consistent = is_consistent && distance < threshold;
+    if (is_consistent) {
+        statistics.nb_consistent_pairs++;
+    }
+    return is_consistent;
+}
+
+double PairwiseConsistency::getChiSquaredThreshold() const {
     // Determination of the chi squared threshold (numbers from chi-squared table)
-    double threshold;
     if (nb_degree_freedom_ == 3){
-        threshold = 0.58;
+        return 0.58;
     } else {
-        threshold = 2.20;
+        return 2.20;
     }
+}
 
-    // Preallocate consistency matrix
-    Eigen::MatrixXi consistency_matrix(loop_closures_.size(), loop_closures_.size());
-
-    // Iterate on loop closures
-    size_t u = 0;
-    for (const auto& loop_closure_1: loop_closures_) {
-        size_t v = 0;
-        for (const auto& loop_closure_2: loop_closures_) {
-            if (u < v) {
-                // Extract pose indexes
-                size_t i,j,k,l;
-                i = loop_closure_1.first;
-                k = loop_closure_1.second;
-                j = loop_closure_2.first;
-                l = loop_closure_2.second;
-
-                // Check if the loop closures are interrobot. 
-                // It is the case if {i,j} are elements of trajectory_robot1 and {k,l} are elements of trajectory_robot2.
-                // Or the inverse.
-                bool is_config_r12 = graph_utils::isInTrajectory(trajectory_robot1_, i) && graph_utils::isInTrajectory(trajectory_robot1_, j) &&
-                    graph_utils::isInTrajectory(trajectory_robot2_, k) && graph_utils::isInTrajectory(trajectory_robot2_, l);
-                bool is_config_r21 = graph_utils::isInTrajectory(trajectory_robot2_, i) && graph_utils::isInTrajectory(trajectory_robot2_, j) &&
-                    graph_utils::isInTrajectory(trajectory_robot1_, k) && graph_utils::isInTrajectory(trajectory_robot1_, l);
-                // Compute only if they are interrobot loop closures
-                if (is_config_r12 || is_config_r21) {
-                    // Extract transforms
-                    geometry_msgs::PoseWithCovariance abZik = (*transforms_interrobot_.transforms.find(loop_closure_1)).second.pose;
-                    geometry_msgs::PoseWithCovariance abZjl = (*transforms_interrobot_.transforms.find(loop_closure_2)).second.pose; 
-                    geometry_msgs::PoseWithCovariance aXij, bXlk;
-                    if (is_config_r12) {
-                        aXij = composeOnTrajectory(i, j, 1);  
-                        bXlk = composeOnTrajectory(l, k, 2); 
-                    } else {
-                        aXij = composeOnTrajectory(i, j, 2);  
-                        bXlk = composeOnTrajectory(l, k, 1); 
-                    }
-                    // Compute the consistency pose (should be near Identity if consistent)
-                    geometry_msgs::PoseWithCovariance consistency_pose = computeConsistencyPose(aXij, bXlk, abZik, abZjl);
-                    // Compute the Mahalanobis distance
-                    double distance = computeSquaredMahalanobisDistance(consistency_pose);
-                    // Apply threshold on the chi-squared distribution
-                    if (distance < threshold) {
-                        consistency_matrix(u,v) = 1;
-                    } else {
-                        consistency_matrix(u,v) = 0;
-                    }
+template <typename TileFunction>
+void PairwiseConsistency::forEachTile(const size_t& first_column, const TileFunction& process_tile) const {
+    // Tiles of the upper triangle, in row order
+    const size_t nb_loop_closures = loop_closures_.size();
+    std::vector<std::pair<size_t, size_t>> tiles;
+    for (size_t row = 0; row < nb_loop_closures; row += TILE_SIZE) {
+        for (size_t col = std::max(row, first_column); col < nb_loop_closures; col += TILE_SIZE) {
+            tiles.emplace_back(row, col);
+        }
+    }
+
+    // The cost of a tile varies, so the threads take the next tile when they are done
+    std::atomic<size_t> next_tile(0);
+    auto process_tiles = [&](const size_t& thread) {
+        for (size_t tile = next_tile++; tile < tiles.size(); tile = next_tile++) {
+            const size_t row = tiles[tile].first, col = tiles[tile].second;
+            process_tile(thread, row, std::min(row + TILE_SIZE, nb_loop_closures), col, std::min(col + TILE_SIZE, nb_loop_closures));
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t thread = 1; thread < std::min(nb_threads_, tiles.size()); thread++) {
+        threads.emplace_back(process_tiles, thread);
+    }
+    process_tiles(0);
+    for (auto& thread: threads) {
+        thread.join();
+    }
+}
+
+template <typename Pose>
+bool PairwiseConsistency::computePairSquaredDistance(const ConsistencyPoses<Pose>& poses, const size_t& u, const size_t& v,
+                                                     const double& threshold, double& distance, ConsistencyStatistics& statistics) const {
+    // The loop closures are interrobot with the same orientation if {i,j} are elements of trajectory_robot1
+    // and {k,l} are elements of trajectory_robot2. Or the inverse.
+    const LoopClosureEntry& entry_ik = poses.loop_closure_entries[u];
+    const LoopClosureEntry& entry_jl = poses.loop_closure_entries[v];
+    const uint8_t orientations = entry_ik.orientations & entry_jl.orientations;
+    // Compute only if they are interrobot loop closures
+    if (orientations == 0) {
+        return false;
+    }
+    const int robot_a = (orientations & LoopClosureEntry::ROBOT1_TO_ROBOT2) ? 0 : 1;
+    const int robot_b = 1 - robot_a;
+    statistics.nb_interrobot_pairs++;
+
+    // Stage one : the residual of the loop without the covariances, against a bound of the covariance
+    if (use_early_rejection_ && isRejectedEarly(poses, robot_a, robot_b, entry_ik, entry_jl, u, v, threshold)) {
+        statistics.nb_early_rejected_pairs++;
+        return false;
+    }
+
+    Pose consistency_pose;
+    if (use_odometry_relative_poses_) {
+        // Compute the consistency pose from the relative poses on the trajectories : aXij + abZjl + bXlk - abZik.
+        // Its covariance is dominated by the one composed from the absolute poses, so the bounds above still hold
+        Pose aXij, bXlk, out1, out2;
+        getOdometryRelativePose(poses, robot_a, entry_ik.first_indexes[robot_a], entry_jl.first_indexes[robot_a], aXij);
+        getOdometryRelativePose(poses, robot_b, entry_jl.second_indexes[robot_b], entry_ik.second_indexes[robot_b], bXlk);
+        graph_utils::compose(aXij, poses.loop_closures[v], out1);
+        graph_utils::compose(out1, bXlk, out2);
+        graph_utils::inverseCompose(out2, poses.loop_closures[u], consistency_pose);
+    } else {
+        // Compute the consistency pose (should be near Identity if consistent) : (abZik^-1 + aXi^-1) + (aXj + abZjl + bXl^-1) + bXk
+        Pose row_column;
+        graph_utils::compose(poses.row_terms[robot_a][u], poses.column_terms[robot_a][v], row_column);
+        graph_utils::compose(row_column, poses.trajectories[robot_b][entry_ik.second_indexes[robot_b]], consistency_pose);
+    }
+    // Compute the Mahalanobis distance
+    distance = computeSquaredMahalanobisDistance(consistency_pose);
+    statistics.nb_evaluated_pairs++;
+    return true;
+}
+
+template <typename Pose>
+bool PairwiseConsistency::isRejectedEarly(const ConsistencyPoses<Pose>& poses, const int& robot_a, const int& robot_b,
+                                          const LoopClosureEntry& entry_ik, const LoopClosureEntry& entry_jl,
+                                          const size_t& u, const size_t& v, const double& threshold) const {
+    // Consistency loop (abZik^-1 + aXi^-1) + (aXj + abZjl + bXl^-1) + bXk, without the covariances.
+    // Only its position is needed : the row transformation applied to the column transformation of bXk
+    const typename ConsistencyPoses<Pose>::LoopTransformations& row = poses.loop_transformations[robot_a][u];
+    const typename ConsistencyPoses<Pose>::LoopTransformations& column = poses.loop_transformations[robot_a][v];
+    const auto position_in_row = column.column * row.second_position;
+    const auto position = row.row * position_in_row;
+
+    // Exact lever arms of the factors, from their end, or from their start if they are inverted.
+    // The lever arms of aXi^-1 and abZjl are measured before the row rotation, which preserves the norms
+    const double lever_il = (position_in_row - column.column_origins[1]).norm();
+    const double levers[6] = {position.norm(), (position - row.row_origin).norm(),
+                              (position_in_row - column.column_origins[0]).norm(), lever_il, lever_il, 0};
+    const double position_covariance_trace = boundPositionCovarianceTrace(robot_a, robot_b, entry_ik, entry_jl, u, v, levers);
+
+    // The squared Mahalanobis distance is at least the one of the position, which is at least
+    // its squared norm over the largest eigenvalue of its covariance
+    return position.squaredNorm() > threshold * position_covariance_trace;
+}
+
+double PairwiseConsistency::boundPositionCovarianceTrace(const int& robot_a, const int& robot_b, const LoopClosureEntry& entry_ik,
+                                                         const LoopClosureEntry& entry_jl, const size_t& u, const size_t& v,
+                                                         const double levers[6]) const {
+    // The consistency pose is the composition of abZik^-1, aXi^-1, aXj, abZjl, bXl^-1 and bXk, with independent covariances.
+    // The Jacobian of its position with respect to each of them has a norm of at most 1 for the translation and
+    // angle_factor * lever arm for the angles. So the factor adds at most
+    // (sqrt(tr(translation)) + angle_factor * lever * sqrt(tr(angles)))^2 to the trace of the covariance of the position.
+    const StandardDeviations* deviations[6] = {&rejection_bounds_.loop_closure_deviations[u],
+                                               &rejection_bounds_.deviations[robot_a][entry_ik.first_indexes[robot_a]],
+                                               &rejection_bounds_.deviations[robot_a][entry_jl.first_indexes[robot_a]],
+                                               &rejection_bounds_.loop_closure_deviations[v],
+                                               &rejection_bounds_.deviations[robot_b][entry_jl.second_indexes[robot_b]],
+                                               &rejection_bounds_.deviations[robot_b][entry_ik.second_indexes[robot_b]]};
+    double trace = 0;
+    for (int factor = 0; factor < 6; factor++) {
+        const double deviation = deviations[factor]->translation + rejection_bounds_.angle_factor * levers[factor] * deviations[factor]->angles;
+        trace += deviation * deviation;
+    }
+    return trace;
+}
+
+template <typename Pose, typename PairFunction>
+void PairwiseConsistency::forEachConsistentPair(const ConsistencyPoses<Pose>& poses, const size_t& first_column,
+                                                const double& threshold, const PairFunction& add_pair) {
+    std::vector<ConsistencyStatistics> thread_statistics(nb_threads_);
+
+    // Iterate on the pairs of loop closures
+    forEachTile(first_column, [&](const size_t& thread, const size_t& row_begin, const size_t& row_end, const size_t& col_begin, const size_t& col_end) {
+        ConsistencyStatistics statistics;
+        for (size_t u = row_begin; u < row_end; u++) {
+            for (size_t v = std::max(col_begin, u + 1); v < col_end; v++) {
+                double distance;
+                // Apply threshold on the chi-squared distribution
+                if (computePairSquaredDistance(poses, u, v, threshold, distance, statistics) && distance < threshold) {
+                    add_pair(thread, u, v, distance);
+                    statistics.nb_consistent_pairs++;
                 }
             }
-            v++;
         }
-        u++;
+        thread_statistics[thread] += statistics;
+    });
+
+    statistics_ = ConsistencyStatistics();
+    const size_t nb_loop_closures = loop_closures_.size(), nb_old_loop_closures = std::min(first_column, nb_loop_closures);
+    statistics_.nb_pairs = nb_loop_closures * (nb_loop_closures - std::min<size_t>(nb_loop_closures, 1)) / 2 -
+                           nb_old_loop_closures * (nb_old_loop_closures - std::min<size_t>(nb_old_loop_closures, 1)) / 2;
+    for (const auto& statistics: thread_statistics) {
+        statistics_ += statistics;
     }
+}
+
+template <typename Pose>
+Eigen::MatrixXi PairwiseConsistency::computeConsistencyMatrix(const ConsistencyPoses<Pose>& poses) {
+    // Preallocate consistency matrix
+    Eigen::MatrixXi consistency_matrix = Eigen::MatrixXi::Zero(loop_closures_.size(), loop_closures_.size());
+
+    // Each entry is written by a single thread
+    forEachConsistentPair(poses, 0, getChiSquaredThreshold(), [&](const size_t&, const size_t& u, const size_t& v, const double&) {
+        consistency_matrix(u,v) = 1;
+    });
     return consistency_matrix;
 }
 
-geometry_msgs::PoseWithCovariance PairwiseConsistency::computeConsistencyPose(const geometry_msgs::PoseWithCovariance& aXij, 
-                                                        const geometry_msgs::PoseWithCovariance& bXlk, 
-                                                        const geometry_msgs::PoseWithCovariance& abZik, 
-                                                        const geometry_msgs::PoseWithCovariance& abZjl) {
-    // Consistency loop : aXij + abZjl + bXlk - abZik
-    geometry_msgs::PoseWithCovariance out1, out2, result;
-    graph_utils::poseCompose(aXij, abZjl, out1);
-    graph_utils::poseCompose(out1, bXlk, out2);
-    graph_utils::poseInverseCompose(out2, abZik, result);
+template <typename Pose>
+graph_utils::ConsistencyGraph PairwiseConsistency::computeConsistencyGraph(const ConsistencyPoses<Pose>& poses) {
+    // One edge buffer per thread
+    std::vector<graph_utils::ConsistencyGraph::Edges> edge_buffers(nb_threads_);
 
-    return result;
+    forEachConsistentPair(poses, 0, getChiSquaredThreshold(), [&](const size_t& thread, const size_t& u, const size_t& v, const double&) {
+        edge_buffers[thread].emplace_back(u, v);
+    });
+    return graph_utils::ConsistencyGraph(loop_closures_.size(), edge_buffers);
 }
 
-double PairwiseConsistency::computeSquaredMahalanobisDistance(const geometry_msgs::PoseWithCovariance& transform) {
-    // Extraction of the covariance matrix
-    Eigen::Matrix<double, 6, 6> covariance_matrix;
-    for (int i = 0; i < 6; i++) {
-        for (int j = 0; j < 6; j++) {
-            covariance_matrix(i,j) = transform.covariance[i*6+j];
-        }
+template <typename Pose>
+graph_utils::PackedConsistencyMatrix PairwiseConsistency::computePackedConsistencyMatrix(const ConsistencyPoses<Pose>& poses) {
+    graph_utils::PackedConsistencyMatrix consistency_matrix(loop_closures_.size());
+
+    // The rows are not aligned on the words, so the tiles share words
+    forEachConsistentPair(poses, 0, getChiSquaredThreshold(), [&](const size_t&, const size_t& u, const size_t& v, const double&) {
+        consistency_matrix.setConcurrently(u, v);
+    });
+    return consistency_matrix;
+}
+
+template <typename Pose>
+graph_utils::ConsistencyDistances PairwiseConsistency::computeConsistencyDistances(const ConsistencyPoses<Pose>& poses, const double& max_threshold) {
+    // One buffer per thread
+    std::vector<graph_utils::ConsistencyDistances::Entries> entry_buffers(nb_threads_);
+
+    forEachConsistentPair(poses, 0, max_threshold, [&](const size_t& thread, const size_t& u, const size_t& v, const double& distance) {
+        entry_buffers[thread].push_back({(uint32_t) u, (uint32_t) v, (float) distance});
+    });
+    return graph_utils::ConsistencyDistances(loop_closures_.size(), max_threshold, entry_buffers);
+}
+
+template <typename Pose>
+void PairwiseConsistency::computeLoopTerms(ConsistencyPoses<Pose>& poses, const size_t& index, const int& robot_a) {
+    // The factors are independent, so the first order propagation of the covariances through the
+    // partial compositions gives the same covariance as through the whole consistency loop
+    const int robot_b = 1 - robot_a;
+    const LoopClosureEntry& entry = poses.loop_closure_entries[index];
+    const Pose& Z = poses.loop_closures[index];
+    const Pose& X_first = poses.trajectories[robot_a][entry.first_indexes[robot_a]];
+    const Pose& X_second = poses.trajectories[robot_b][entry.second_indexes[robot_b]];
+    Pose inverse_Z, inverse_X_first, inverse_X_second, X_first_Z;
+
+    // As the loop closure (i, k) of the row : abZik^-1 + aXi^-1
+    graph_utils::inverse(Z, inverse_Z);
+    graph_utils::inverse(X_first, inverse_X_first);
+    graph_utils::compose(inverse_Z, inverse_X_first, poses.row_terms[robot_a][index]);
+
+    // As the loop closure (j, l) of the column : aXj + abZjl + bXl^-1
+    graph_utils::inverse(X_second, inverse_X_second);
+    graph_utils::compose(X_first, Z, X_first_Z);
+    graph_utils::compose(X_first_Z, inverse_X_second, poses.column_terms[robot_a][index]);
+
+    // Means, with the intermediate positions which give the lever arms of the early rejection
+    typename ConsistencyPoses<Pose>::LoopTransformations& transformations = poses.loop_transformations[robot_a][index];
+    const auto Z_transformation = getTransformation(Z);
+    const auto X_first_transformation = getTransformation(X_first);
+    transformations.row = Z_transformation.inverse() * X_first_transformation.inverse();
+    transformations.row_origin = Z_transformation.inverse().translation();
+    transformations.second_position = getTransformation(X_second).translation();
+    transformations.column = X_first_transformation * Z_transformation * getTransformation(X_second).inverse();
+    transformations.column_origins[0] = X_first_transformation.translation();
+    transformations.column_origins[1] = (X_first_transformation * Z_transformation).translation();
+}
+
+template <typename Pose>
+void PairwiseConsistency::getOdometryRelativePose(const ConsistencyPoses<Pose>& poses, const int& robot, const size_t& index1,
+                                                  const size_t& index2, Pose& result) const {
+    // A planar query of the tree costs about as much as the lookup in the cache (no measurable gain on CSAIL)
+    if (graph_utils::PoseTraits<Pose>::DIMENSION == 3) {
+        poses.odometries[robot].getRelativePose(index1, index2, result);
+        return;
     }
+    // Many pairs share a pose of each of their loop closures, the cache is keyed by the pose IDs
+    const size_t start_id = robot == 0 ? trajectory_robot1_.start_id : trajectory_robot2_.start_id;
+    poses.relative_poses.get(robot, start_id + index1, start_id + index2, [&](Pose& relative_pose) {
+        poses.odometries[robot].getRelativePose(index1, index2, relative_pose);
+    }, result);
+}
 
-    // Extraction of the pose vector
-    Eigen::Matrix<double, 6, 1> pose_vector(6);
-    pose_vector(0) = transform.pose.position.x;
-    pose_vector(1) = transform.pose.position.y;
-    pose_vector(2) = transform.pose.position.z;
-    pose_vector(3) = transform.pose.orientation.x;
-    pose_vector(4) = transform.pose.orientation.y;
-    pose_vector(5) = transform.pose.orientation.z;
+double PairwiseConsistency::computeSquaredMahalanobisDistance(const graph_utils::PoseSE2& transform) {
+    // Pose vector (x, y, qz), the covariance is on (x, y, yaw)
+    const Eigen::Vector3d pose_vector(transform.mean(0), transform.mean(1), std::sin(transform.mean(2) / 2));
 
     // Computation of the squared Mahalanobis distance
-    double distance = pose_vector.transpose() * covariance_matrix.inverse() * pose_vector;
-    return distance;
+    return graph_utils::squaredMahalanobisDistance<3>(pose_vector, transform.covariance);
 }
 
-geometry_msgs::PoseWithCovariance PairwiseConsistency::composeOnTrajectory(const size_t& id1, const size_t& id2, const size_t& robot_id) {
-    // Select trajectory
-    graph_utils::Trajectory trajectory;
-    if (robot_id == 1) {
-        trajectory = trajectory_robot1_;
-    } else {
-        trajectory = trajectory_robot2_;
-    }
-    
-    // Extraction of the poses on the trajectory
-    graph_utils::TrajectoryPose pose1 = (*trajectory.trajectory_poses.find(id1)).second;
-    graph_utils::TrajectoryPose pose2 = (*trajectory.trajectory_poses.find(id2)).second;
-    // Computation of the transformation
-    geometry_msgs::PoseWithCovariance result;
-    graph_utils::poseInverseCompose(pose2.pose, pose1.pose, result);
-    return result;
+double PairwiseConsistency::computeSquaredMahalanobisDistance(const graph_utils::PoseSE3& transform) {
+    // Pose vector (x, y, z, qz, qy, qx), in the order of the covariance on (x, y, z, yaw, pitch, roll)
+    geometry_msgs::Quaternion q;
+    graph_utils::getQuaternion(transform, q);
+    Eigen::Matrix<double, 6, 1> pose_vector;
+    pose_vector << transform.translation, q.z, q.y, q.x;
+
+    // Computation of the squared Mahalanobis distance
+    return graph_utils::squaredMahalanobisDistance<6>(pose_vector, transform.covariance);
 }
 
 const graph_utils::LoopClosures& PairwiseConsistency::getLoopClosures() const {
@@ -138,4 +513,22 @@ const graph_utils::Transforms& PairwiseConsistency::getTransformsInterRobot() co
     return transforms_interrobot_;
 }
 
-}
\ No newline at end of file
+const graph_utils::DynamicConsistencyGraph& PairwiseConsistency::getConsistencyGraph() const{
+    return consistency_graph_;
+}
+
+const ConsistencyStatistics& PairwiseConsistency::getStatistics() const{
+    return statistics_;
+}
+
+template <>
+const ConsistencyPoses<graph_utils::PoseSE2>& PairwiseConsistency::getLoopClosureTable<graph_utils::PoseSE2>() const{
+    return poses_se2_;
+}
+
+template <>
+const ConsistencyPoses<graph_utils::PoseSE3>& PairwiseConsistency::getLoopClosureTable<graph_utils::PoseSE3>() const{
+    return poses_se3_;
+}
+
+}
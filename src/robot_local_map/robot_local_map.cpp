@@ -5,8 +5,26 @@
 
 namespace robot_local_map {
 
-RobotLocalMap::RobotLocalMap(const std::string & file_name): RobotMeasurements(file_name, false) {
-    trajectory_ = graph_utils::buildTrajectory(transforms_);
+RobotLocalMap::RobotLocalMap(const std::string & file_name, const size_t& nb_threads) {
+    if (graph_utils::isPoseGraphBinaryFile(file_name)) {
+        // The file is mapped once, for the measurements and the trajectory
+        const graph_utils::PoseGraphBinaryFile file(file_name);
+        loadBinaryFile(file);
+        loadTrajectory(file);
+    } else {
+        loadG2oFile(file_name, false, nb_threads);
+        trajectory_ = graph_utils::buildTrajectory(transforms_);
+    }
+}
+
+RobotLocalMap::RobotLocalMap(const graph_utils::PoseGraphBinaryFile& file): RobotMeasurements(file) {
+    loadTrajectory(file);
+}
+
+void RobotLocalMap::loadTrajectory(const graph_utils::PoseGraphBinaryFile& file) {
+    if (!file.loadTrajectory(trajectory_)) {
+        trajectory_ = graph_utils::buildTrajectory(transforms_);
+    }
 }
 
 const graph_utils::Trajectory& RobotLocalMap::getTrajectory() const {
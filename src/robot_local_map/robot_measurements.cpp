@@ -2,11 +2,38 @@
 
 #include "robot_local_map/robot_measurements.h"
 #include "graph_utils/graph_utils_functions.h"
+#include "graph_utils/g2o_parser.h"
 
 namespace robot_local_map {
 
-RobotMeasurements::RobotMeasurements(const std::string & file_name, const bool& is_only_loop_closures){
-    nb_degree_freedom_ = graph_utils::parseG2ofile(file_name, num_poses_, transforms_, loop_closures_, is_only_loop_closures);
+RobotMeasurements::RobotMeasurements(const std::string & file_name, const bool& is_only_loop_closures, const size_t& nb_threads){
+    if (graph_utils::isPoseGraphBinaryFile(file_name)) {
+        loadBinaryFile(graph_utils::PoseGraphBinaryFile(file_name));
+    } else {
+        loadG2oFile(file_name, is_only_loop_closures, nb_threads);
+    }
+}
+
+RobotMeasurements::RobotMeasurements(const graph_utils::PoseGraphBinaryFile& file){
+    loadBinaryFile(file);
+}
+
+RobotMeasurements::RobotMeasurements(): num_poses_(0), nb_degree_freedom_(0) {}
+
+void RobotMeasurements::loadG2oFile(const std::string & file_name, const bool& is_only_loop_closures, const size_t& nb_threads){
+    if (nb_threads == 1) {
+        nb_degree_freedom_ = graph_utils::parseG2ofileMapped(file_name, num_poses_, transforms_, loop_closures_, is_only_loop_closures);
+    } else {
+        nb_degree_freedom_ = graph_utils::parseG2ofileParallel(file_name, num_poses_, transforms_, loop_closures_, is_only_loop_closures, nb_threads);
+    }
+}
+
+void RobotMeasurements::loadBinaryFile(const graph_utils::PoseGraphBinaryFile& file){
+    if (!file.isValid()) {
+        std::cerr << "Error while opening the binary pose graph file" << std::endl;
+        std::abort();
+    }
+    nb_degree_freedom_ = file.load(num_poses_, transforms_, loop_closures_);
 }
 
 const graph_utils::Transforms& RobotMeasurements::getTransforms() const {
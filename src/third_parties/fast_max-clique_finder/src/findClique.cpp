@@ -24,6 +24,7 @@ int pruned1;
 int pruned2;
 int pruned3;
 int pruned5;
+long expandedNodes;
 
 /* Algorithm 2: CLIQUE: Recursive Subroutine of algorithm 1. */
 void maxCliqueHelper( CGraphIO& gio, vector<int>* U, int sizeOfClique, int& maxClq, vector<int>& max_clique_data_inter )
@@ -33,6 +34,7 @@ void maxCliqueHelper( CGraphIO& gio, vector<int>* U, int sizeOfClique, int& maxC
 	vector <int>* ptrEdge = gio.GetEdgesPtr();
 	vector <int> U_new;
    U_new.reserve(gio.GetVertexCount());
+   expandedNodes++;
 
 	if( U->size() == 0  )
 	{
@@ -97,6 +99,7 @@ int maxClique( CGraphIO& gio, int l_bound, vector<int>& max_clique_data )
 	pruned2 = 0;
 	pruned3 = 0;
 	pruned5 = 0;
+	expandedNodes = 0;
 
 	//Bit Vector to track if vertex has been considered previously.
 	int *bitVec = new int[gio.GetVertexCount()];
@@ -41,10 +41,14 @@ void usage(char *argv0);
 int getDegree(vector<int>* ptrVtx, int idx);
 void print_max_clique(vector<int>& max_clique_data);
 
+// Number of calls of maxCliqueHelper during the last maxClique
+extern long expandedNodes;
+
 int maxClique( CGraphIO& gio, int l_bound, vector<int>& max_clique_data );
 void maxCliqueHelper( CGraphIO& gio, vector<int>* U, int sizeOfClique, int& maxClq, vector<int>& max_clique_data_inter );
 
-int maxCliqueHeu( CGraphIO& gio );
+// Heuristic clique, its size is a lower bound for maxClique. Returns -1 if the graph has no vertex.
+int maxCliqueHeu( CGraphIO& gio, vector<int>& max_clique_data );
 void maxCliqueHelperHeu( CGraphIO& gio, vector<int>* U, int sizeOfClique, int& maxClq, vector<int>& max_clique_data_inter );
 
 }
@@ -27,7 +27,7 @@ namespace FMC {
 int maxDegree, maxClq;
 
 /* Algorithm 2: MaxCliqueHeu: A heuristic to find maximum clique */
-int maxCliqueHeu(CGraphIO& gio)
+int maxCliqueHeu(CGraphIO& gio, vector<int>& max_clique_data)
 {
 	vector <int>* p_v_i_Vertices = gio.GetVerticesPtr();
 	vector <int>* p_v_i_Edges = gio.GetEdgesPtr();
@@ -38,6 +38,9 @@ int maxCliqueHeu(CGraphIO& gio)
 	int maxClq = - 1, u, icc;
 	vector < int > v_i_S;
 	vector < int > v_i_S1;
+	vector < int > v_i_Clique;
+	vector < char > v_c_IsNeighbor(p_v_i_Vertices->size(), 0);
+	max_clique_data.clear();
 	v_i_S.resize(maxDegree + 1, 0);
 	v_i_S1.resize(maxDegree + 1, 0);
 
@@ -68,11 +71,16 @@ int maxCliqueHeu(CGraphIO& gio)
 		}
 
 		icc = 0;
+		v_i_Clique.clear();
 		
 		while(iPos > 0)
 		{
 			int imdv1 = -1, imd1 = -1;
 
+			// even with all the vertices of S, the clique would not be larger than the best one
+			if(icc + iPos <= maxClq)
+				break;
+
 			icc++;
 
 			// generate a random number x from 0 to iPos -1
@@ -80,24 +88,26 @@ int maxCliqueHeu(CGraphIO& gio)
 			//imdv = v_i_S[rand() % iPos];
 			imdv = v_i_S[iPos-1];
 			imd = (*p_v_i_Vertices)[imdv + 1] - (*p_v_i_Vertices)[imdv];
+			// the vertices picked are adjacent to all the previous ones
+			v_i_Clique.push_back(imdv);
 
 			iPos1 = 0;
 
+			// mark the neighbors of imdv, instead of searching each vertex of S in its adjacency
+			iLoopCount = (*p_v_i_Vertices)[imdv + 1];
+			for(int k = (*p_v_i_Vertices)[imdv]; k < iLoopCount; k++)
+				v_c_IsNeighbor[(*p_v_i_Edges)[k]] = 1;
+
 			for(int j = 0; j < iPos; j++)
 			{
-				iLoopCount = (*p_v_i_Vertices)[imdv + 1];
-				for(int k = (*p_v_i_Vertices)[imdv]; k < iLoopCount; k++)
-				{
-					// Pruning 5
-					if(v_i_S[j] == (*p_v_i_Edges)[k] && maxClq <= ((*p_v_i_Vertices)[(*p_v_i_Edges)[k] + 1] - (*p_v_i_Vertices)[(*p_v_i_Edges)[k]]))
-					{
-						v_i_S1[iPos1++] = v_i_S[j]; // calculate the max degree vertex here
-						
-						break;
-					}
-				}
+				// Pruning 5
+				if(v_c_IsNeighbor[v_i_S[j]] && maxClq <= ((*p_v_i_Vertices)[v_i_S[j] + 1] - (*p_v_i_Vertices)[v_i_S[j]]))
+					v_i_S1[iPos1++] = v_i_S[j]; // calculate the max degree vertex here
 			}
 
+			for(int k = (*p_v_i_Vertices)[imdv]; k < iLoopCount; k++)
+				v_c_IsNeighbor[(*p_v_i_Edges)[k]] = 0;
+
 			for(int j = 0; j < iPos1; j++)
 				v_i_S[j] = v_i_S1[j];
 			
@@ -108,7 +118,10 @@ int maxCliqueHeu(CGraphIO& gio)
 		}
 	
 		if(maxClq < icc)
+		{
 			maxClq = icc;
+			max_clique_data = v_i_Clique;
+		}
 			
 	}
 
@@ -19,7 +19,113 @@
 
 #include "graphIO.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdlib.h>
+
 namespace FMC {
+
+namespace {
+
+// Read-only mapping of a whole file, released by the destructor
+class MappedInput
+{
+public:
+	MappedInput(const string& s_InputFile) : m_p_Data(NULL), m_i_Size(0), m_b_Open(false)
+	{
+		int fd = open(s_InputFile.c_str(), O_RDONLY);
+		if(fd < 0)
+			return;
+		struct stat fileStat;
+		if(fstat(fd, &fileStat) == 0)
+		{
+			m_i_Size = fileStat.st_size;
+			if(m_i_Size == 0)
+				m_b_Open = true;
+			else
+			{
+				void* mapping = mmap(NULL, m_i_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if(mapping != MAP_FAILED)
+				{
+					madvise(mapping, m_i_Size, MADV_SEQUENTIAL);
+					m_p_Data = static_cast<const char*>(mapping);
+					m_b_Open = true;
+				}
+			}
+		}
+		close(fd);
+	}
+
+	~MappedInput()
+	{
+		if(m_p_Data != NULL)
+			munmap(const_cast<char*>(m_p_Data), m_i_Size);
+	}
+
+	const char* m_p_Data;
+	size_t m_i_Size;
+	bool m_b_Open;
+
+private:
+	MappedInput(const MappedInput&);
+	MappedInput& operator=(const MappedInput&);
+};
+
+// Line starting at p, without its end of line, p is moved to the next line
+string nextLine(const char*& p, const char* end)
+{
+	const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+	if(eol == NULL)
+		eol = end;
+	string line(p, eol);
+	p = eol < end ? eol + 1 : end;
+	return line;
+}
+
+inline void skipBlanks(const char*& p, const char* end)
+{
+	while(p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+		p++;
+}
+
+// Integer at p, the input is not null-terminated
+inline bool parseInt(const char*& p, const char* end, long& value)
+{
+	skipBlanks(p, end);
+	bool negative = false;
+	if(p < end && (*p == '-' || *p == '+'))
+	{
+		negative = *p == '-';
+		p++;
+	}
+	if(p == end || *p < '0' || *p > '9')
+		return false;
+	value = 0;
+	while(p < end && *p >= '0' && *p <= '9')
+		value = value * 10 + (*p++ - '0');
+	if(negative)
+		value = -value;
+	return true;
+}
+
+// Floating point value at p, copied before strtod since the input is not null-terminated
+inline bool parseDouble(const char*& p, const char* end, double& value)
+{
+	skipBlanks(p, end);
+	char token[LINE_LENGTH];
+	size_t length = 0;
+	while(p < end && length + 1 < LINE_LENGTH && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n')
+		token[length++] = *p++;
+	token[length] = '\0';
+	char* tokenEnd;
+	value = strtod(token, &tokenEnd);
+	return length > 0 && tokenEnd == token + length;
+}
+
+}
+
 CGraphIO::~CGraphIO()
 {
 	m_vi_Vertices.clear();
@@ -34,7 +140,7 @@ bool CGraphIO::readGraph(string s_InputFile, float connStrength)
 	if(fileExtension == "mtx")
 	{
 		// matrix market format
-		return ReadMatrixMarketAdjacencyGraph(s_InputFile, connStrength);
+		return ReadMatrixMarketAdjacencyGraphMapped(s_InputFile, connStrength);
 	}
 	else if(fileExtension == "gr")
 	{
@@ -186,11 +292,150 @@ bool CGraphIO::ReadMatrixMarketAdjacencyGraph(string s_InputFile, float connStre
 }
 
 
+bool CGraphIO::ReadMatrixMarketAdjacencyGraphMapped(string s_InputFile, float connStrength)
+{
+	MappedInput input(s_InputFile);
+	if(!input.m_b_Open)
+	{
+		cout<<s_InputFile<<" not Found!"<<endl;
+		return false;
+	}
+	const char* p = input.m_p_Data;
+	const char* end = input.m_p_Data + input.m_i_Size;
+
+	// read the banner, the comments and the size, as ReadMatrixMarketAdjacencyGraph
+	char data[LINE_LENGTH];
+	char banner[LINE_LENGTH];
+	char mtx[LINE_LENGTH];
+	char crd[LINE_LENGTH];
+	char data_type[LINE_LENGTH];
+	char storage_scheme[LINE_LENGTH];
+	char* c;
+	bool b_getValue = true;
+
+	string line = nextLine(p, end);
+	strncpy(data, line.c_str(), LINE_LENGTH - 1);
+	data[LINE_LENGTH - 1] = '\0';
+	if (sscanf(data, "%s %s %s %s %s", banner, mtx, crd, data_type, storage_scheme) != 5)
+	{
+		cout << "Matrix file banner is missing!!!" << endl;
+		return false;
+	}
+	for (c=data_type; *c!='\0'; *c=tolower(*c),c++);
+	if (strcmp(data_type, "pattern") == 0)
+		b_getValue = false;
+
+	line = nextLine(p, end);
+	while(line.size()>0&&line[0]=='%') //ignore comment line
+		line = nextLine(p, end);
+	int row=0, col=0, num_of_entries=0;
+	sscanf(line.c_str(), "%d %d %d", &row, &col, &num_of_entries);
+	if(row!=col)
+	{
+		cout<<"* WARNING: GraphInputOutput::ReadMatrixMarketAdjacencyGraphMapped()"<<endl;
+		cout<<"*\t row!=col. This is not a square matrix. Can't process."<<endl;
+		return false;
+	}
+
+	// Entries, as two arcs each : 2e is rowIndex -> colIndex and 2e + 1 is colIndex -> rowIndex
+	vector<int> sources, targets;
+	vector<double> values;
+	sources.reserve(2 * num_of_entries);
+	targets.reserve(2 * num_of_entries);
+	for(int entry_counter = 0; p < end && entry_counter < num_of_entries; entry_counter++)
+	{
+		const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+		if(eol == NULL)
+			eol = end;
+		long rowIndex = 0, colIndex = 0;
+		double value = 0;
+		skipBlanks(p, eol);
+		if(p < eol)
+		{
+			const bool b_parsed = parseInt(p, eol, rowIndex) && parseInt(p, eol, colIndex);
+			rowIndex--;
+			colIndex--;
+			if(!b_parsed || rowIndex < 0 || rowIndex >= row || colIndex < 0 || colIndex >= col)
+				cout << "Something wrong rowIndex " << rowIndex << " colIndex " << colIndex << " row " << row << ", entry skipped" << endl;
+			else if(rowIndex != colIndex && (!b_getValue || (parseDouble(p, eol, value) && value > connStrength)))
+			{
+				sources.push_back(rowIndex);
+				targets.push_back(colIndex);
+				sources.push_back(colIndex);
+				targets.push_back(rowIndex);
+				if(b_getValue)
+					values.push_back(value);
+			}
+		}
+		p = eol < end ? eol + 1 : end;
+	}
+
+	// First pass of counting sort, by target, then second pass, stable, by source : the arcs of each
+	// source end up sorted by target, the duplicates in the order of the file
+	const size_t nb_arcs = sources.size();
+	vector<int> counts(row + 1, 0);
+	for(size_t arc = 0; arc < nb_arcs; arc++)
+		counts[targets[arc] + 1]++;
+	for(int i = 0; i < row; i++)
+		counts[i + 1] += counts[i];
+	vector<int> byTarget(nb_arcs);
+	for(size_t arc = 0; arc < nb_arcs; arc++)
+		byTarget[counts[targets[arc]]++] = arc;
+
+	counts.assign(row + 1, 0);
+	for(size_t arc = 0; arc < nb_arcs; arc++)
+		counts[sources[arc] + 1]++;
+	for(int i = 0; i < row; i++)
+		counts[i + 1] += counts[i];
+	vector<int> sorted(nb_arcs);
+	vector<int> offsets(counts.begin(), counts.end());
+	for(size_t k = 0; k < nb_arcs; k++)
+	{
+		const int arc = byTarget[k];
+		sorted[offsets[sources[arc]]++] = arc;
+	}
+	vector<int>().swap(byTarget);
+
+	// Unique : the first occurrence of an edge is kept, with its value
+	m_vi_Vertices.assign(1, 0);
+	m_vi_Vertices.reserve(row + 1);
+	m_vi_Edges.clear();
+	m_vi_Edges.reserve(nb_arcs);
+	m_vd_Values.clear();
+	for(int i = 0; i < row; i++)
+	{
+		for(int k = counts[i]; k < counts[i + 1]; k++)
+		{
+			const int arc = sorted[k];
+			if(k > counts[i] && targets[arc] == targets[sorted[k - 1]])
+				continue;
+			m_vi_Edges.push_back(targets[arc]);
+			if(b_getValue)
+				m_vd_Values.push_back(values[arc / 2]);
+		}
+		m_vi_Vertices.push_back(m_vi_Edges.size());
+	}
+
+	CalculateVertexDegrees();
+	return true;
+}
+
 bool CGraphIO::ReadMeTiSAdjacencyGraph(string s_InputFile)
 {
 	return true;
 }
 
+void CGraphIO::SetAdjacencyGraph(vector<int>& vi_Vertices, vector<int>& vi_Edges)
+{
+	// Same arrays as ReadMatrixMarketAdjacencyGraph, swapped instead of copied
+	m_s_InputFile = "";
+	m_vi_Vertices.swap(vi_Vertices);
+	m_vi_Edges.swap(vi_Edges);
+	m_vi_OrderedVertices.clear();
+	m_vd_Values.clear();
+	CalculateVertexDegrees();
+}
+
 void CGraphIO::CalculateVertexDegrees()
 {
 		int i_VertexCount = m_vi_Vertices.size() - 1;
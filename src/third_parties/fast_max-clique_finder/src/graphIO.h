@@ -45,7 +45,12 @@ public:
 	bool readGraph(string s_InputFile, float connStrength = -DBL_MAX);
 	string getFileExtension(string fileName);
 	bool ReadMatrixMarketAdjacencyGraph(string s_InputFile, float connStrength = -DBL_MAX);
+	// Same graph as ReadMatrixMarketAdjacencyGraph in O(V + E) : the file is mapped in memory, the
+	// edges are sorted by two passes of counting sort and the duplicates removed. The neighbors are sorted.
+	bool ReadMatrixMarketAdjacencyGraphMapped(string s_InputFile, float connStrength = -DBL_MAX);
 	bool ReadMeTiSAdjacencyGraph(string s_InputFile);
+	// Takes the CSR arrays of a graph built in memory, without going through a file
+	void SetAdjacencyGraph(vector<int>& vi_Vertices, vector<int>& vi_Edges);
 	void CalculateVertexDegrees();
 
 	int GetVertexCount(){ return m_vi_Vertices.size() - 1; }